@@ -70,6 +70,7 @@ typedef HPDF_HANDLE   HPDF_XObject;
 typedef HPDF_HANDLE   HPDF_Annotation;
 typedef HPDF_HANDLE   HPDF_ExtGState;
 typedef HPDF_HANDLE   HPDF_FontDef;
+typedef HPDF_HANDLE   HPDF_SharedTTFont;
 typedef HPDF_HANDLE   HPDF_U3D;
 typedef HPDF_HANDLE   HPDF_JavaScript;
 typedef HPDF_HANDLE   HPDF_Error;
@@ -107,6 +108,14 @@ HPDF_NewEx  (HPDF_Error_Handler   user_error_fn,
              HPDF_UINT            mem_pool_buf_size,
              void                *user_data);
 
+HPDF_EXPORT(HPDF_Doc)
+HPDF_NewWithAllocator  (HPDF_Error_Handler   user_error_fn,
+                        HPDF_AllocEx_Func    alloc_fn,
+                        HPDF_FreeEx_Func     free_fn,
+                        void                *alloc_data,
+                        HPDF_UINT            mem_pool_buf_size,
+                        void                *user_data);
+
 HPDF_EXPORT(HPDF_Doc)
 HPDF_New  (HPDF_Error_Handler   user_error_fn,
            void                *user_data);
@@ -127,6 +136,10 @@ HPDF_EXPORT(HPDF_STATUS)
 HPDF_NewDoc  (HPDF_Doc  pdf);
 
 
+HPDF_EXPORT(HPDF_STATUS)
+HPDF_ResetDoc  (HPDF_Doc  pdf);
+
+
 HPDF_EXPORT(void)
 HPDF_FreeDoc  (HPDF_Doc  pdf);
 
@@ -166,6 +179,25 @@ HPDF_SaveToFile  (HPDF_Doc     pdf,
                   const char  *file_name);
 
 
+/* progressive save: content streams of finished pages are written to the
+   file as soon as HPDF_FlushPage is called, the rest of the document is
+   written by HPDF_EndProgressiveSave. HPDF_SaveToFile and
+   HPDF_SaveToStream can not be used for such a document. */
+
+HPDF_EXPORT(HPDF_STATUS)
+HPDF_BeginProgressiveSave  (HPDF_Doc     pdf,
+                            const char  *file_name);
+
+
+HPDF_EXPORT(HPDF_STATUS)
+HPDF_FlushPage  (HPDF_Doc   pdf,
+                 HPDF_Page  page);
+
+
+HPDF_EXPORT(HPDF_STATUS)
+HPDF_EndProgressiveSave  (HPDF_Doc  pdf);
+
+
 HPDF_EXPORT(HPDF_STATUS)
 HPDF_GetError  (HPDF_Doc   pdf);
 
@@ -186,6 +218,11 @@ HPDF_SetPagesConfiguration  (HPDF_Doc    pdf,
                              HPDF_UINT   page_per_pages);
 
 
+HPDF_EXPORT(HPDF_STATUS)
+HPDF_ReservePages  (HPDF_Doc    pdf,
+                    HPDF_UINT   page_count);
+
+
 HPDF_EXPORT(HPDF_Page)
 HPDF_GetPageByIndex  (HPDF_Doc    pdf,
                       HPDF_UINT   index);
@@ -320,6 +357,21 @@ HPDF_LoadTTFontFromFile2 (HPDF_Doc     pdf,
                           HPDF_UINT    index,
                           HPDF_BOOL    embedding);
 
+
+HPDF_EXPORT(HPDF_SharedTTFont)
+HPDF_NewSharedTTFont (const char  *file_name);
+
+
+HPDF_EXPORT(void)
+HPDF_FreeSharedTTFont (HPDF_SharedTTFont  font);
+
+
+HPDF_EXPORT(const char*)
+HPDF_LoadSharedTTFont (HPDF_Doc           pdf,
+                       HPDF_SharedTTFont  font,
+                       HPDF_BOOL          embedding);
+
+
 HPDF_EXPORT(const char*)
 HPDF_LoadTTFontFromMemory (HPDF_Doc         pdf,
                            const HPDF_BYTE *buffer,
@@ -494,6 +546,20 @@ HPDF_Page_CreateXObjectAsWhiteRect  (HPDF_Doc   pdf,
                                      HPDF_Page  page,
                                      HPDF_Rect  rect);
 
+
+HPDF_EXPORT(HPDF_XObject)
+HPDF_Page_BeginFormXObject  (HPDF_Page  page,
+                             HPDF_Rect  bbox);
+
+
+HPDF_EXPORT(HPDF_STATUS)
+HPDF_Page_ResumeFormXObject  (HPDF_Page     page,
+                              HPDF_XObject  form);
+
+
+HPDF_EXPORT(HPDF_STATUS)
+HPDF_Page_EndFormXObject  (HPDF_Page  page);
+
 /*--------------------------------------------------------------------------*/
 /*----- annotation ---------------------------------------------------------*/
 
@@ -947,6 +1013,18 @@ HPDF_SetCompressionMode  (HPDF_Doc    pdf,
                           HPDF_UINT   mode);
 
 
+HPDF_EXPORT(HPDF_STATUS)
+HPDF_SetCompressionParams  (HPDF_Doc              pdf,
+                            HPDF_UINT             mode,
+                            HPDF_INT              level,
+                            HPDF_DeflateStrategy  strategy);
+
+
+HPDF_EXPORT(HPDF_STATUS)
+HPDF_SetCompressionThreads  (HPDF_Doc   pdf,
+                             HPDF_UINT  threads);
+
+
 /*--------------------------------------------------------------------------*/
 /*----- font ---------------------------------------------------------------*/
 
@@ -1000,6 +1078,13 @@ HPDF_Font_MeasureText (HPDF_Font          font,
                        HPDF_REAL         *real_width);
 
 
+/* TrueType fonts only: HPDF_TRUE trades 128KB per font definition for
+   character to glyph lookups without searching the cmap segments */
+HPDF_EXPORT(HPDF_STATUS)
+HPDF_Font_SetCMapDirectMode  (HPDF_Font  font,
+                              HPDF_BOOL  enabled);
+
+
 /*--------------------------------------------------------------------------*/
 /*----- attachments -------------------------------------------------------*/
 
@@ -1637,6 +1722,12 @@ HPDF_Page_TextOut  (HPDF_Page    page,
                     const char  *text);
 
 
+HPDF_EXPORT(HPDF_STATUS)
+HPDF_Page_ShowTextRuns  (HPDF_Page             page,
+                         const HPDF_TextRun   *runs,
+                         HPDF_UINT             count);
+
+
 HPDF_EXPORT(HPDF_STATUS)
 HPDF_Page_TextRect  (HPDF_Page            page,
                      HPDF_REAL            left,
@@ -4,6 +4,18 @@
 /* Define to 1 if you have the `z' library (-lz). */
 #define LIBHPDF_HAVE_ZLIB
 
+/* Define to 1 to compress streams with zlib-ng instead of zlib. */
+/* #undef LIBHPDF_HAVE_ZLIB_NG */
+
+/* Define to 1 to compress streams with libdeflate instead of zlib. */
+/* #undef LIBHPDF_HAVE_LIBDEFLATE */
+
+/* Define to 1 if you have the <sys/mman.h> header file (mmap). */
+#define LIBHPDF_HAVE_MMAP
+
+/* Define to 1 if POSIX threads are available (parallel deflate). */
+#define LIBHPDF_HAVE_PTHREAD
+
 /* debug build */
 /* #undef LIBHPDF_DEBUG */
 
@@ -38,6 +38,8 @@ typedef struct _HPDF_Doc_Rec {
     HPDF_PDFVer     pdf_version;
 
     HPDF_MMgr         mmgr;
+    /* end of the document object in the memory pool (HPDF_ResetDoc) */
+    HPDF_MMgr_Mark    mmgr_mark;
     HPDF_Catalog      catalog;
     HPDF_Outline      outlines;
     HPDF_Xref         xref;
@@ -63,6 +65,15 @@ typedef struct _HPDF_Doc_Rec {
     /* default compression mode */
     HPDF_BOOL         compression_mode;
 
+    /* deflate level and strategy of each compression class, packed as in
+       the filter of a stream (HPDF_STREAM_FILTER_FLATE_PARAMS) */
+    HPDF_UINT         text_flate;
+    HPDF_UINT         image_flate;
+    HPDF_UINT         metadata_flate;
+
+    /* number of threads deflating the streams at save time */
+    HPDF_UINT         compression_threads;
+
     HPDF_BOOL         encrypt_on;
     HPDF_EncryptDict  encrypt_dict;
 
@@ -74,6 +85,10 @@ typedef struct _HPDF_Doc_Rec {
     /* buffer for saving into memory stream */
     HPDF_Stream       stream;
 
+    /* file stream of progressive save (HPDF_BeginProgressiveSave) */
+    HPDF_Stream       progressive_stream;
+    HPDF_BOOL         progressive_used;
+
     /* PDF/A conformance */
     HPDF_PDFAType     pdfa_type;
     HPDF_List         xmp_extensions;
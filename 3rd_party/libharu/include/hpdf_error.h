@@ -161,6 +161,7 @@ extern "C" {
 #define HPDF_PAGE_INVALID_BOUNDARY                0x1086
 /*                                                0x1087 */
 #define HPDF_INVALID_SHADING_TYPE                 0x1088
+#define HPDF_PAGE_ALREADY_FLUSHED                 0x1089
 
 /*---------------------------------------------------------------------------*/
 
@@ -230,6 +230,8 @@ typedef struct _HPDF_TTF_CmapRange {
         HPDF_UINT16  *id_range_offset;
         HPDF_UINT16  *glyph_id_array;
         HPDF_UINT     glyph_id_array_count;
+        /* glyph ids of all BMP characters (HPDF_TTFontDef_SetDirectCMap) */
+        HPDF_UINT16  *direct_map;
 } HPDF_TTF_CmapRange;
 
 
@@ -314,6 +316,11 @@ typedef struct _HPDF_TTFontDefAttr_Rec {
     HPDF_BOOL                is_cidfont;
 
     HPDF_Stream              stream;
+
+    /* the attributes of a shared font (HPDF_SharedTTFont) whose tables are
+       borrowed by this one, NULL if the tables are owned. only glyph_tbl.flgs
+       and stream belong to a fontdef created by HPDF_TTFontDef_NewShared. */
+    struct _HPDF_TTFontDefAttr_Rec  *source;
 } HPDF_TTFontDefAttr_Rec;
 
 
@@ -335,11 +342,58 @@ HPDF_TTFontDef_Load2  (HPDF_MMgr     mmgr,
                        HPDF_BOOL     embedding);
 
 
+/*----- HPDF_SharedTTFont ----------------------------------------------------*/
+
+/*  a TrueType font loaded and parsed once, then shared read-only by any
+ *  number of documents, also from different threads. it keeps the whole
+ *  font file mapped (or loaded) in memory for embedding; each document gets
+ *  a fontdef of its own which borrows the parsed tables and only owns the
+ *  set of used glyphs.
+ */
+
+#define HPDF_SHARED_TTFONT_SIG_BYTES  0x53545446L
+
+typedef struct _HPDF_SharedTTFont_Rec  *HPDF_SharedTTFont;
+
+typedef struct _HPDF_SharedTTFont_Rec {
+    HPDF_UINT32     sig_bytes;
+    HPDF_Error_Rec  error;
+    HPDF_MMgr       mmgr;
+    HPDF_Stream     file;   /* the mapping of the file, NULL if it was read */
+    HPDF_BYTE      *data;
+    HPDF_UINT       size;
+    HPDF_FontDef    fontdef;
+} HPDF_SharedTTFont_Rec;
+
+
+HPDF_SharedTTFont
+HPDF_SharedTTFont_New  (const char  *file_name);
+
+
+void
+HPDF_SharedTTFont_Dispose  (HPDF_SharedTTFont  font);
+
+
+HPDF_BOOL
+HPDF_SharedTTFont_Validate  (HPDF_SharedTTFont  font);
+
+
+HPDF_FontDef
+HPDF_TTFontDef_NewShared  (HPDF_MMgr          mmgr,
+                           HPDF_SharedTTFont  font,
+                           HPDF_BOOL          embedding);
+
+
 HPDF_UINT16
 HPDF_TTFontDef_GetGlyphid  (HPDF_FontDef   fontdef,
                             HPDF_UINT16    unicode);
 
 
+HPDF_STATUS
+HPDF_TTFontDef_SetDirectCMap  (HPDF_FontDef   fontdef,
+                               HPDF_BOOL      enabled);
+
+
 HPDF_INT16
 HPDF_TTFontDef_GetCharWidth  (HPDF_FontDef   fontdef,
                               HPDF_UINT16    unicode);
@@ -430,7 +430,14 @@ typedef struct _HPDF_Dict_Rec {
     HPDF_Stream                stream;
     HPDF_UINT                  filter;
     HPDF_Dict                  filterParams;
+    /* stream data deflated ahead of writing (HPDF_Xref_DeflateStreams) and
+       the size of the data it was made from */
+    HPDF_Stream                deflated;
+    HPDF_UINT                  deflated_from;
     void                       *attr;
+    /* open-addressing hash index of the elements (NULL for small dicts) */
+    struct _HPDF_DictElement_Rec  **index;
+    HPDF_UINT                  index_size;
 } HPDF_Dict_Rec;
 
 
@@ -439,6 +446,7 @@ typedef struct _HPDF_DictElement_Rec *HPDF_DictElement;
 typedef struct _HPDF_DictElement_Rec {
     char   key[HPDF_LIMIT_MAX_NAME_LEN + 1];
     void        *value;
+    HPDF_UINT32  hash;
 } HPDF_DictElement_Rec;
 
 
@@ -536,6 +544,8 @@ typedef struct _HPDF_XrefEntry_Rec {
       HPDF_UINT    byte_offset;
       HPDF_UINT16  gen_no;
       void*        obj;
+      /* object has already been written by progressive save */
+      HPDF_BOOL    flushed;
 } HPDF_XrefEntry_Rec;
 
 
@@ -543,7 +553,9 @@ typedef struct _HPDF_Xref_Rec {
       HPDF_MMgr    mmgr;
       HPDF_Error   error;
       HPDF_UINT32  start_offset;
-      HPDF_List    entries;
+      /* entries are stored in blocks of HPDF_XREF_ENTRIES_PER_BLOCK */
+      HPDF_List    entry_blocks;
+      HPDF_UINT    count;
       HPDF_UINT    addr;
       HPDF_Xref    prev;
       HPDF_Dict    trailer;
@@ -564,6 +576,11 @@ HPDF_Xref_Add  (HPDF_Xref  xref,
                 void       *obj);
 
 
+HPDF_STATUS
+HPDF_Xref_Reserve  (HPDF_Xref  xref,
+                    HPDF_UINT  count);
+
+
 HPDF_XrefEntry
 HPDF_Xref_GetEntry  (HPDF_Xref  xref,
                      HPDF_UINT  index);
@@ -580,6 +597,21 @@ HPDF_Xref_GetEntryByObjectId  (HPDF_Xref  xref,
                                HPDF_UINT  obj_id);
 
 
+HPDF_STATUS
+HPDF_Xref_FlushObject  (HPDF_Xref     xref,
+                        void          *obj,
+                        HPDF_Stream   stream);
+
+
+/*  deflate the FlateDecode streams which are not written yet on up to
+ *  'threads' threads. without thread support it does nothing and the
+ *  streams are deflated as they are written.
+ */
+HPDF_STATUS
+HPDF_Xref_DeflateStreams  (HPDF_Xref  xref,
+                           HPDF_UINT  threads);
+
+
 
 typedef HPDF_Dict  HPDF_EmbeddedFile;
 typedef HPDF_Dict  HPDF_NameDict;
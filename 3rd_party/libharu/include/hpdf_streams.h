@@ -34,7 +34,8 @@ typedef enum _HPDF_StreamType {
     HPDF_STREAM_UNKNOWN = 0,
     HPDF_STREAM_CALLBACK,
     HPDF_STREAM_FILE,
-    HPDF_STREAM_MEMORY
+    HPDF_STREAM_MEMORY,
+    HPDF_STREAM_BUFFER
 } HPDF_StreamType;
 
 #define HPDF_STREAM_FILTER_NONE          0x0000
@@ -44,6 +45,18 @@ typedef enum _HPDF_StreamType {
 #define HPDF_STREAM_FILTER_DCT_DECODE    0x0800
 #define HPDF_STREAM_FILTER_CCITT_DECODE  0x1000
 
+/* deflate parameters of a FlateDecode stream are kept in the low byte of
+ * the filter, so they follow the filter wherever it is copied.
+ * level is stored as level + 1 and strategy as is, 0 means the zlib default.
+ */
+#define HPDF_STREAM_FILTER_FLATE_LEVEL_MASK      0x000F
+#define HPDF_STREAM_FILTER_FLATE_STRATEGY_MASK   0x00F0
+#define HPDF_STREAM_FILTER_FLATE_STRATEGY_SHIFT  4
+
+#define HPDF_STREAM_FILTER_FLATE_PARAMS(level, strategy) \
+    ((HPDF_UINT)((level) + 1) | \
+     ((HPDF_UINT)(strategy) << HPDF_STREAM_FILTER_FLATE_STRATEGY_SHIFT))
+
 typedef enum _HPDF_WhenceMode {
     HPDF_SEEK_SET = 0,
     HPDF_SEEK_CUR,
@@ -96,6 +109,17 @@ typedef struct _HPDF_MemStreamAttr_Rec {
 } HPDF_MemStreamAttr_Rec;
 
 
+typedef struct _HPDF_BufferReaderAttr_Rec  *HPDF_BufferReaderAttr;
+
+
+typedef struct _HPDF_BufferReaderAttr_Rec {
+    const HPDF_BYTE  *buf;
+    HPDF_UINT        size;
+    HPDF_UINT        pos;
+    HPDF_BOOL        mapped;  /* buf is a file mapping owned by the stream */
+} HPDF_BufferReaderAttr_Rec;
+
+
 typedef struct _HPDF_Stream_Rec {
     HPDF_UINT32               sig_bytes;
     HPDF_StreamType           type;
@@ -142,6 +166,19 @@ void
 HPDF_MemStream_FreeData  (HPDF_Stream  stream);
 
 
+/*  deflate the data of a memory stream with the parameters of 'filter' into
+ *  a buffer allocated with malloc, which the caller releases with free.
+ *  neither the memory manager nor the error object of the stream is used,
+ *  so different streams may be deflated on different threads at once.
+ */
+HPDF_STATUS
+HPDF_MemStream_Deflate  (HPDF_Stream  src,
+                         HPDF_UINT    filter,
+                         HPDF_BYTE    **buf,
+                         HPDF_UINT    *size,
+                         HPDF_INT     *detail);
+
+
 HPDF_STATUS
 HPDF_Stream_WriteToStream  (HPDF_Stream   src,
                             HPDF_Stream   dst,
@@ -168,6 +205,27 @@ HPDF_CallbackReader_New  (HPDF_MMgr              mmgr,
                           void*                  data);
 
 
+HPDF_Stream
+HPDF_BufferReader_New  (HPDF_MMgr         mmgr,
+                        const HPDF_BYTE  *buf,
+                        HPDF_UINT         size);
+
+
+const HPDF_BYTE*
+HPDF_BufferReader_Read  (HPDF_Stream  stream,
+                         HPDF_UINT    size);
+
+
+const HPDF_BYTE*
+HPDF_BufferReader_GetBuf  (HPDF_Stream  stream,
+                           HPDF_UINT   *size);
+
+
+HPDF_Stream
+HPDF_MappedFileReader_New  (HPDF_MMgr    mmgr,
+                            const char  *fname);
+
+
 HPDF_Stream
 HPDF_CallbackWriter_New (HPDF_MMgr               mmgr,
                          HPDF_Stream_Write_Func  write_fn,
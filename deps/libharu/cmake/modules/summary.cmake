@@ -42,6 +42,7 @@ LIBHPDF_EXAMPLES:  ${LIBHPDF_EXAMPLES}
 Optional libraries:
 HAVE_ZLIB:   ${LIBHPDF_HAVE_ZLIB}
 HAVE_LIBPNG: ${LIBHPDF_HAVE_LIBPNG}
+DEFLATE_BACKEND: ${LIBHPDF_DEFLATE_BACKEND}
 ")
 message("${_output_results}")
 endmacro(summary)
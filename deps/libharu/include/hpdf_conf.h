@@ -56,11 +56,17 @@
 /* default buffer size of memory-stream-object */
 #define HPDF_STREAM_BUF_SIZ         4096
 
+/* block size of the memory stream collecting a non-memory stream for deflate */
+#define HPDF_DEFLATE_BUF_SIZ        65536
+
 /* default array size of list-object */
 #define HPDF_DEF_ITEMS_PER_BLOCK    20
 
-/* default array size of cross-reference-table */
-#define HPDF_DEFALUT_XREF_ENTRY_NUM 1024
+/* number of dictionary elements from which the hash index of keys is built */
+#define HPDF_DICT_INDEX_THRESHOLD   8
+
+/* number of cross-reference entries allocated at once (power of 2) */
+#define HPDF_XREF_ENTRIES_PER_BLOCK 256
 
 /* default array size of widths-table of cid-fontdef */
 #define HPDF_DEF_CHAR_WIDTHS_NUM    128
@@ -68,17 +74,24 @@
 /* default array size of page-list-tablef */
 #define HPDF_DEF_PAGE_LIST_NUM      256
 
+/* number of indirect objects created with a page (page, contents, length) */
+#define HPDF_PAGE_OBJECTS_NUM       3
+
+/* upper bound of the Kids array reserved for an intermediate pages node */
+#define HPDF_MAX_KIDS_RESERVE       8191
+
 /* default array size of range-table of cid-fontdef */
 #define HPDF_DEF_RANGE_TBL_NUM      128
 
-/* default buffer size of memory-pool-object */
+/* default buffer size of memory-pool-object. every new node of the pool
+ * is twice as large as the previous one, up to HPDF_MAX_MPOOL_BUF_SIZ */
 #define HPDF_MPOOL_BUF_SIZ          8192
 #define HPDF_MIN_MPOOL_BUF_SIZ      256
-#define HPDF_MAX_MPOOL_BUF_SIZ      1048576
+#define HPDF_MAX_MPOOL_BUF_SIZ      4194304
 
 /* alignment size of memory-pool-object
  */
-#define HPDF_ALIGNMENT_SIZE            sizeof(int)
+#define HPDF_ALIGNMENT_SIZE            sizeof(double)
 
 #define G3CODES
 
@@ -4,6 +4,18 @@
 /* Define to 1 if you have the `z' library (-lz). */
 #cmakedefine LIBHPDF_HAVE_ZLIB
 
+/* Define to 1 to compress streams with zlib-ng instead of zlib. */
+#cmakedefine LIBHPDF_HAVE_ZLIB_NG
+
+/* Define to 1 to compress streams with libdeflate instead of zlib. */
+#cmakedefine LIBHPDF_HAVE_LIBDEFLATE
+
+/* Define to 1 if you have the <sys/mman.h> header file (mmap). */
+#cmakedefine LIBHPDF_HAVE_MMAP
+
+/* Define to 1 if POSIX threads are available (parallel deflate). */
+#cmakedefine LIBHPDF_HAVE_PTHREAD
+
 /* debug build */
 #cmakedefine LIBHPDF_DEBUG
 
@@ -81,6 +81,11 @@
  */
 #define  HPDF_COMP_MASK            0xFF
 
+/* deflate level for HPDF_SetCompressionParams: 0 (store) .. 9 (best) */
+#define  HPDF_COMP_LEVEL_DEFAULT   -1
+#define  HPDF_COMP_LEVEL_SPEED     1
+#define  HPDF_COMP_LEVEL_BEST      9
+
 
 /*----------------------------------------------------------------------------*/
 /*----- permission flags (only Revision 2 is supported)-----------------------*/
@@ -93,11 +93,13 @@ typedef HPDF_UNICODE
 (*HPDF_Encoder_ToUnicode_Func)  (HPDF_Encoder   encoder,
                                  HPDF_UINT16    code);
 
-typedef char *
+/* writes the codes of the text to out, which must hold 2 * len bytes,
+   and returns their length */
+typedef HPDF_UINT
 (*HPDF_Encoder_EncodeText_Func)  (HPDF_Encoder  encoder,
 				  const char   *text,
 				  HPDF_UINT     len,
-				  HPDF_UINT    *encoded_length);
+				  HPDF_BYTE    *out);
 
 typedef HPDF_STATUS
 (*HPDF_Encoder_Write_Func)  (HPDF_Encoder  encoder,
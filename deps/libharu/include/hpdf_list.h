@@ -51,6 +51,11 @@ HPDF_List_Add  (HPDF_List  list,
                 void       *item);
 
 
+HPDF_STATUS
+HPDF_List_Reserve  (HPDF_List  list,
+                    HPDF_UINT  count);
+
+
 HPDF_STATUS
 HPDF_List_Insert  (HPDF_List  list,
                    void       *target,
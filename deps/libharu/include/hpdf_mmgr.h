@@ -41,7 +41,11 @@ typedef struct  _HPDF_MMgr_Rec {
     HPDF_Error        error;
     HPDF_Alloc_Func   alloc_fn;
     HPDF_Free_Func    free_fn;
+    HPDF_AllocEx_Func alloc_ex_fn;
+    HPDF_FreeEx_Func  free_ex_fn;
+    void             *alloc_data;
     HPDF_MPool_Node   mpool;
+    HPDF_MPool_Node   spare;    /* nodes released by HPDF_MMgr_Release */
     HPDF_UINT         buf_size;
 
 #ifdef HPDF_MEM_DEBUG
@@ -51,6 +55,13 @@ typedef struct  _HPDF_MMgr_Rec {
 } HPDF_MMgr_Rec;
 
 
+/* position in the memory pool (HPDF_MMgr_GetMark) */
+typedef struct  _HPDF_MMgr_Mark {
+    HPDF_MPool_Node  node;
+    HPDF_UINT        used_size;
+} HPDF_MMgr_Mark;
+
+
 /*  HPDF_mpool_new
  *
  *  create new HPDF_mpool object. when memory allocation goes wrong,
@@ -64,6 +75,19 @@ HPDF_MMgr_New  (HPDF_Error       error,
                 HPDF_Free_Func   free_fn);
 
 
+/*  HPDF_MMgr_NewEx
+ *
+ *  same as HPDF_MMgr_New, but the allocation functions receive alloc_data
+ *  with every call.
+ */
+HPDF_MMgr
+HPDF_MMgr_NewEx  (HPDF_Error         error,
+                  HPDF_UINT          buf_size,
+                  HPDF_AllocEx_Func  alloc_fn,
+                  HPDF_FreeEx_Func   free_fn,
+                  void              *alloc_data);
+
+
 void
 HPDF_MMgr_Free  (HPDF_MMgr  mmgr);
 
@@ -73,6 +97,22 @@ HPDF_GetMem  (HPDF_MMgr  mmgr,
               HPDF_UINT  size);
 
 
+/*  HPDF_MMgr_GetMark / HPDF_MMgr_Release
+ *
+ *  HPDF_MMgr_Release discards every allocation of the memory pool made
+ *  after HPDF_MMgr_GetMark returned the mark. the released nodes are kept
+ *  and used again before new nodes are allocated. without a memory pool
+ *  HPDF_MMgr_Release does nothing.
+ */
+HPDF_MMgr_Mark
+HPDF_MMgr_GetMark  (HPDF_MMgr  mmgr);
+
+
+void
+HPDF_MMgr_Release  (HPDF_MMgr       mmgr,
+                    HPDF_MMgr_Mark  mark);
+
+
 void
 HPDF_FreeMem  (HPDF_MMgr  mmgr,
                void       *aptr);
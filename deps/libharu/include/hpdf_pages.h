@@ -64,6 +64,7 @@ typedef struct _HPDF_PageAttr_Rec {
     HPDF_UINT16        gmode;
     HPDF_Dict          contents;
     HPDF_Stream        stream;
+    HPDF_Dict          form;
     HPDF_Xref          xref;
     HPDF_UINT          compression_mode;
 	HPDF_PDFVer       *ver; 
@@ -128,6 +129,11 @@ HPDF_Page_CheckState  (HPDF_Page  page,
                        HPDF_UINT  mode);
 
 
+HPDF_STATUS
+HPDF_Page_Flush  (HPDF_Page    page,
+                  HPDF_Stream  stream);
+
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
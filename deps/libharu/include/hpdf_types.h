@@ -206,6 +206,17 @@ typedef void
 (HPDF_STDCALL *HPDF_Free_Func)  (void  *aptr);
 
 
+/* allocation functions with a context pointer (HPDF_NewWithAllocator) */
+typedef void*
+(HPDF_STDCALL *HPDF_AllocEx_Func)  (void       *alloc_data,
+                                    HPDF_UINT   size);
+
+
+typedef void
+(HPDF_STDCALL *HPDF_FreeEx_Func)  (void  *alloc_data,
+                                   void  *aptr);
+
+
 /*---------------------------------------------------------------------------*/
 /*------ text width struct --------------------------------------------------*/
 
@@ -221,6 +232,19 @@ typedef struct _HPDF_TextWidth {
 } HPDF_TextWidth;
 
 
+/*---------------------------------------------------------------------------*/
+/*------ text run struct ----------------------------------------------------*/
+
+/* a string shown at an absolute position by HPDF_Page_ShowTextRuns.
+   text need not be null-terminated, len is its length in bytes. */
+typedef struct _HPDF_TextRun {
+    HPDF_REAL    x;
+    HPDF_REAL    y;
+    const char  *text;
+    HPDF_UINT    len;
+} HPDF_TextRun;
+
+
 /*---------------------------------------------------------------------------*/
 /*------ dash mode ----------------------------------------------------------*/
 
@@ -333,6 +357,17 @@ typedef enum _HPDF_TextRenderingMode {
 } HPDF_TextRenderingMode;
 
 
+/* the values match the strategies of zlib */
+typedef enum _HPDF_DeflateStrategy {
+    HPDF_DEFLATE_DEFAULT = 0,
+    HPDF_DEFLATE_FILTERED,
+    HPDF_DEFLATE_HUFFMAN_ONLY,
+    HPDF_DEFLATE_RLE,
+    HPDF_DEFLATE_FIXED,
+    HPDF_DEFLATE_STRATEGY_EOF
+} HPDF_DeflateStrategy;
+
+
 typedef enum _HPDF_WritingMode {
     HPDF_WMODE_HORIZONTAL = 0,
     HPDF_WMODE_VERTICAL,
@@ -0,0 +1,420 @@
+/*
+ * << Haru Free PDF Library >> -- hpdf_deflate.c
+ *
+ * URL: http://libharu.org
+ *
+ * Copyright (c) 1999-2006 Takeshi Kanno <takeshi_kanno@est.hi-ho.ne.jp>
+ * Copyright (c) 2007-2009 Antony Dovgal <tony@daylessday.org>
+ *
+ * Permission to use, copy, modify, distribute and sell this software
+ * and its documentation for any purpose is hereby granted without fee,
+ * provided that the above copyright notice appear in all copies and
+ * that both that copyright notice and this permission notice appear
+ * in supporting documentation.
+ * It is provided "as is" without express or implied warranty.
+ *
+ */
+
+#include "hpdf_conf.h"
+#include "hpdf_consts.h"
+#include "hpdf_utils.h"
+#include "hpdf_objects.h"
+#include "hpdf.h"
+
+#ifdef LIBHPDF_HAVE_ZLIB
+
+#include <stdlib.h>
+
+#if defined(LIBHPDF_HAVE_LIBDEFLATE)
+#include <libdeflate.h>
+#elif defined(LIBHPDF_HAVE_ZLIB_NG)
+#include <zlib-ng.h>
+#else
+#include <zlib.h>
+#endif
+
+/*----------------------------------------------------------------------------*/
+/*----- deflate backends -----------------------------------------------------*/
+
+/*
+ *  the data of a memory stream is compressed at once into a buffer of the
+ *  deflate bound. the backend is chosen at build time (LIBHPDF_DEFLATE_BACKEND):
+ *  zlib, the native API of zlib-ng or libdeflate. all of them produce the
+ *  zlib format which FlateDecode expects.
+ */
+
+#ifdef LIBHPDF_HAVE_LIBDEFLATE
+
+static HPDF_STATUS
+DeflateBlocks  (HPDF_MemStreamAttr  attr,
+                HPDF_UINT           src_size,
+                int                 level,
+                int                 strategy,
+                HPDF_BYTE           **buf,
+                HPDF_UINT           *size,
+                HPDF_INT            *detail)
+{
+    struct libdeflate_compressor *c;
+    HPDF_BYTE *in;
+    size_t bound;
+    HPDF_UINT i;
+
+    /* libdeflate has no strategies */
+    HPDF_UNUSED (strategy);
+
+    c = libdeflate_alloc_compressor (level < 0 ? 6 : level);
+    if (!c) {
+        *detail = level;
+        return HPDF_ZLIB_ERROR;
+    }
+
+    /* the input must be contiguous, a stream of several blocks is gathered */
+    if (attr->buf->count == 1) {
+        in = (HPDF_BYTE *)HPDF_List_ItemAt (attr->buf, 0);
+    } else {
+        HPDF_BYTE *p = in = (HPDF_BYTE *)malloc (src_size);
+        if (!in) {
+            libdeflate_free_compressor (c);
+            return HPDF_FAILED_TO_ALLOC_MEM;
+        }
+
+        for (i = 0; i < attr->buf->count; i++) {
+            HPDF_UINT len = (i == attr->buf->count - 1) ? attr->w_pos :
+                    attr->buf_siz;
+
+            HPDF_MemCpy (p, (HPDF_BYTE *)HPDF_List_ItemAt (attr->buf, i), len);
+            p += len;
+        }
+    }
+
+    bound = libdeflate_zlib_compress_bound (c, src_size);
+    *buf = (HPDF_BYTE *)malloc (bound);
+    if (*buf)
+        *size = (HPDF_UINT)libdeflate_zlib_compress (c, in, src_size, *buf,
+                bound);
+
+    if (attr->buf->count != 1)
+        free (in);
+    libdeflate_free_compressor (c);
+
+    if (!*buf)
+        return HPDF_FAILED_TO_ALLOC_MEM;
+
+    if (*size == 0) {
+        free (*buf);
+        *buf = NULL;
+        return HPDF_ZLIB_ERROR;
+    }
+
+    return HPDF_OK;
+}
+
+#else /* LIBHPDF_HAVE_LIBDEFLATE */
+
+/* zlib-ng without the compatibility layer has the same API with a prefix */
+#ifdef LIBHPDF_HAVE_ZLIB_NG
+#define HPDF_Z(name)  zng_##name
+typedef zng_stream  HPDF_ZStream;
+#else
+#define HPDF_Z(name)  name
+typedef z_stream  HPDF_ZStream;
+#endif
+
+static HPDF_STATUS
+DeflateBlocks  (HPDF_MemStreamAttr  attr,
+                HPDF_UINT           src_size,
+                int                 level,
+                int                 strategy,
+                HPDF_BYTE           **buf,
+                HPDF_UINT           *size,
+                HPDF_INT            *detail)
+{
+    HPDF_ZStream strm;
+    unsigned long bound;
+    HPDF_UINT i;
+    int ret;
+
+    HPDF_MemSet (&strm, 0x00, sizeof(HPDF_ZStream));
+
+    ret = HPDF_Z(deflateInit2) (&strm, level, Z_DEFLATED, MAX_WBITS,
+            MAX_MEM_LEVEL, strategy);
+    if (ret != Z_OK) {
+        *detail = ret;
+        return HPDF_ZLIB_ERROR;
+    }
+
+    /* the whole output fits in one buffer, it is shrunk afterwards */
+    bound = HPDF_Z(deflateBound) (&strm, src_size);
+    *buf = (HPDF_BYTE *)malloc (bound);
+    if (!*buf) {
+        HPDF_Z(deflateEnd) (&strm);
+        return HPDF_FAILED_TO_ALLOC_MEM;
+    }
+
+    strm.next_out = *buf;
+    strm.avail_out = (unsigned int)bound;
+
+    /* the blocks of the memory stream, the last one is filled up to w_pos */
+    for (i = 0; i < attr->buf->count && ret == Z_OK; i++) {
+        strm.next_in = (HPDF_BYTE *)HPDF_List_ItemAt (attr->buf, i);
+        strm.avail_in = (i == attr->buf->count - 1) ? attr->w_pos :
+                attr->buf_siz;
+
+        ret = HPDF_Z(deflate) (&strm, Z_NO_FLUSH);
+    }
+
+    if (ret == Z_OK)
+        ret = HPDF_Z(deflate) (&strm, Z_FINISH);
+
+    HPDF_Z(deflateEnd) (&strm);
+
+    if (ret != Z_STREAM_END) {
+        free (*buf);
+        *buf = NULL;
+        *detail = ret;
+        return HPDF_ZLIB_ERROR;
+    }
+
+    *size = (HPDF_UINT)strm.total_out;
+
+    return HPDF_OK;
+}
+
+#endif /* LIBHPDF_HAVE_LIBDEFLATE */
+
+
+HPDF_STATUS
+HPDF_MemStream_Deflate  (HPDF_Stream  src,
+                         HPDF_UINT    filter,
+                         HPDF_BYTE    **buf,
+                         HPDF_UINT    *size,
+                         HPDF_INT     *detail)
+{
+    HPDF_MemStreamAttr attr = (HPDF_MemStreamAttr)src->attr;
+    int level = (int)(filter & HPDF_STREAM_FILTER_FLATE_LEVEL_MASK) - 1;
+    int strategy = (int)((filter & HPDF_STREAM_FILTER_FLATE_STRATEGY_MASK) >>
+            HPDF_STREAM_FILTER_FLATE_STRATEGY_SHIFT);
+    HPDF_STATUS ret;
+
+    *buf = NULL;
+    *size = 0;
+    *detail = 0;
+
+    if (src->type != HPDF_STREAM_MEMORY || src->size == 0)
+        return HPDF_INVALID_PARAMETER;
+
+    ret = DeflateBlocks (attr, src->size, level, strategy, buf, size, detail);
+
+    /* the buffer of the bound is usually much larger than the output */
+    if (ret == HPDF_OK) {
+        HPDF_BYTE *p = (HPDF_BYTE *)realloc (*buf, *size);
+        if (p)
+            *buf = p;
+    }
+
+    return ret;
+}
+
+#endif /* LIBHPDF_HAVE_ZLIB */
+
+
+#if defined(LIBHPDF_HAVE_ZLIB) && defined(LIBHPDF_HAVE_PTHREAD)
+
+#include <pthread.h>
+
+/*----------------------------------------------------------------------------*/
+/*----- parallel deflate of stream objects -----------------------------------*/
+
+/*
+ *  the streams of a document are deflated independently of each other, so
+ *  before the objects are written they are compressed by a pool of threads,
+ *  each into a buffer of its own. HPDF_Dict_Write then writes the ready data
+ *  in object order.
+ *
+ *  the memory manager and the error object are not thread-safe: the workers
+ *  only read the memory stream of their object (HPDF_MemStream_Deflate). the
+ *  results are moved into memory streams of the document on the calling
+ *  thread after all the workers have finished.
+ */
+
+typedef struct _HPDF_DeflateJob_Rec {
+    HPDF_Dict    dict;
+    HPDF_UINT    src_size;
+    HPDF_BYTE    *buf;
+    HPDF_UINT    size;
+    HPDF_STATUS  ret;
+    HPDF_INT     detail;
+} HPDF_DeflateJob_Rec;
+
+typedef struct _HPDF_DeflatePool_Rec {
+    HPDF_DeflateJob_Rec  *jobs;
+    HPDF_UINT            count;
+    HPDF_UINT            next;
+    pthread_mutex_t      lock;
+} HPDF_DeflatePool_Rec;
+
+
+static void *
+DeflateWorker  (void  *arg)
+{
+    HPDF_DeflatePool_Rec *pool = (HPDF_DeflatePool_Rec *)arg;
+
+    for (;;) {
+        HPDF_DeflateJob_Rec *job;
+        HPDF_UINT i;
+
+        pthread_mutex_lock (&pool->lock);
+        i = pool->next++;
+        pthread_mutex_unlock (&pool->lock);
+
+        if (i >= pool->count)
+            break;
+
+        job = &pool->jobs[i];
+        job->ret = HPDF_MemStream_Deflate (job->dict->stream, job->dict->filter,
+                &job->buf, &job->size, &job->detail);
+    }
+
+    return NULL;
+}
+
+
+static HPDF_BOOL
+IsDeflateCandidate  (HPDF_XrefEntry  entry)
+{
+    HPDF_Obj_Header *header = (HPDF_Obj_Header *)entry->obj;
+    HPDF_Dict dict;
+
+    /* objects flushed by progressive save are already written */
+    if (entry->flushed || !header ||
+            (header->obj_class & HPDF_OCLASS_ANY) != HPDF_OCLASS_DICT)
+        return HPDF_FALSE;
+
+    dict = (HPDF_Dict)entry->obj;
+
+    return (dict->stream && dict->stream->type == HPDF_STREAM_MEMORY &&
+            (dict->filter & HPDF_STREAM_FILTER_FLATE_DECODE) &&
+            dict->stream->size > 0);
+}
+
+
+HPDF_STATUS
+HPDF_Xref_DeflateStreams  (HPDF_Xref  xref,
+                           HPDF_UINT  threads)
+{
+    HPDF_DeflatePool_Rec pool;
+    pthread_t *workers;
+    HPDF_UINT nworkers = 0;
+    HPDF_Xref tmp_xref;
+    HPDF_STATUS ret = HPDF_OK;
+    HPDF_UINT count = 0;
+    HPDF_UINT i;
+
+    HPDF_PTRACE((" HPDF_Xref_DeflateStreams\n"));
+
+    for (tmp_xref = xref; tmp_xref; tmp_xref = tmp_xref->prev)
+        for (i = 0; i < tmp_xref->count; i++)
+            if (IsDeflateCandidate (HPDF_Xref_GetEntry (tmp_xref, i)))
+                count++;
+
+    if (threads < 2 || count < 2)
+        return HPDF_OK;
+
+    if (threads > count)
+        threads = count;
+
+    pool.jobs = (HPDF_DeflateJob_Rec *)HPDF_GetMem (xref->mmgr,
+            sizeof(HPDF_DeflateJob_Rec) * count);
+    if (!pool.jobs)
+        return HPDF_Error_GetCode (xref->error);
+
+    /* the calling thread is one of the workers */
+    workers = (pthread_t *)HPDF_GetMem (xref->mmgr,
+            sizeof(pthread_t) * (threads - 1));
+    if (!workers) {
+        HPDF_FreeMem (xref->mmgr, pool.jobs);
+        return HPDF_Error_GetCode (xref->error);
+    }
+
+    HPDF_MemSet (pool.jobs, 0, sizeof(HPDF_DeflateJob_Rec) * count);
+    pool.count = 0;
+    pool.next = 0;
+
+    for (tmp_xref = xref; tmp_xref; tmp_xref = tmp_xref->prev)
+        for (i = 0; i < tmp_xref->count; i++) {
+            HPDF_XrefEntry entry = HPDF_Xref_GetEntry (tmp_xref, i);
+
+            if (IsDeflateCandidate (entry)) {
+                HPDF_DeflateJob_Rec *job = &pool.jobs[pool.count++];
+
+                job->dict = (HPDF_Dict)entry->obj;
+                job->src_size = job->dict->stream->size;
+            }
+        }
+
+    pthread_mutex_init (&pool.lock, NULL);
+
+    /* a thread which cannot be started only leaves more jobs to the rest */
+    for (i = 0; i < threads - 1; i++)
+        if (pthread_create (&workers[nworkers], NULL, DeflateWorker,
+                    &pool) == 0)
+            nworkers++;
+
+    DeflateWorker (&pool);
+
+    for (i = 0; i < nworkers; i++)
+        pthread_join (workers[i], NULL);
+
+    pthread_mutex_destroy (&pool.lock);
+    HPDF_FreeMem (xref->mmgr, workers);
+
+    /* move the results into the objects */
+    for (i = 0; i < pool.count; i++) {
+        HPDF_DeflateJob_Rec *job = &pool.jobs[i];
+        HPDF_Dict dict = job->dict;
+
+        if (ret == HPDF_OK && job->ret != HPDF_OK)
+            ret = HPDF_SetError (xref->error, job->ret, job->detail);
+
+        if (dict->deflated) {
+            HPDF_Stream_Free (dict->deflated);
+            dict->deflated = NULL;
+        }
+
+        if (ret == HPDF_OK) {
+            HPDF_Stream deflated = HPDF_MemStream_New (dict->mmgr, job->size);
+
+            if (deflated && HPDF_Stream_Write (deflated, job->buf, job->size)
+                    == HPDF_OK) {
+                dict->deflated = deflated;
+                dict->deflated_from = job->src_size;
+            } else {
+                if (deflated)
+                    HPDF_Stream_Free (deflated);
+                ret = HPDF_Error_GetCode (xref->error);
+            }
+        }
+
+        if (job->buf)
+            free (job->buf);
+    }
+
+    HPDF_FreeMem (xref->mmgr, pool.jobs);
+
+    return ret;
+}
+
+#else /* LIBHPDF_HAVE_ZLIB && LIBHPDF_HAVE_PTHREAD */
+
+HPDF_STATUS
+HPDF_Xref_DeflateStreams  (HPDF_Xref  xref,
+                           HPDF_UINT  threads)
+{
+    /* the streams are deflated as they are written */
+    HPDF_UNUSED (xref);
+    HPDF_UNUSED (threads);
+
+    return HPDF_OK;
+}
+
+#endif /* LIBHPDF_HAVE_ZLIB && LIBHPDF_HAVE_PTHREAD */
@@ -23,6 +23,25 @@ HPDF_DictElement
 GetElement  (HPDF_Dict      dict,
              const char    *key);
 
+
+static HPDF_UINT32
+HashKey  (const char  *key);
+
+
+static HPDF_STATUS
+ReserveIndex  (HPDF_Dict  dict,
+               HPDF_UINT  count);
+
+
+static void
+IndexInsert  (HPDF_Dict         dict,
+              HPDF_DictElement  element);
+
+
+static void
+IndexRemove  (HPDF_Dict         dict,
+              HPDF_DictElement  element);
+
 /*--------------------------------------------------------------------------*/
 
 HPDF_Dict
@@ -109,6 +128,12 @@ HPDF_Dict_Free  (HPDF_Dict  dict)
     if (dict->stream)
         HPDF_Stream_Free (dict->stream);
 
+    if (dict->deflated)
+        HPDF_Stream_Free (dict->deflated);
+
+    if (dict->index)
+        HPDF_FreeMem (dict->mmgr, dict->index);
+
     HPDF_List_Free (dict->list);
 
     dict->header.obj_class = 0;
@@ -259,8 +284,22 @@ HPDF_Dict_Write  (HPDF_Dict     dict,
         if (e)
             HPDF_Encrypt_Reset (e);
 
-        if ((ret = HPDF_Stream_WriteToStream (dict->stream, stream,
-                        dict->filter, e)) != HPDF_OK)
+        /* data deflated in advance is used unless the stream has grown
+           since, e.g. by before_write_fn of the page */
+        if (dict->deflated &&
+                HPDF_Stream_Size (dict->stream) == dict->deflated_from)
+            ret = HPDF_Stream_WriteToStream (dict->deflated, stream,
+                        HPDF_STREAM_FILTER_NONE, e);
+        else
+            ret = HPDF_Stream_WriteToStream (dict->stream, stream,
+                        dict->filter, e);
+
+        if (dict->deflated) {
+            HPDF_Stream_Free (dict->deflated);
+            dict->deflated = NULL;
+        }
+
+        if (ret != HPDF_OK)
             return ret;
 
         HPDF_Number_SetValue (length, stream->size - strptr);
@@ -332,8 +371,12 @@ HPDF_Dict_Add  (HPDF_Dict        dict,
         HPDF_StrCpy (element->key, key, element->key +
                 HPDF_LIMIT_MAX_NAME_LEN + 1);
         element->value = NULL;
+        element->hash = HashKey (element->key);
+
+        ret = ReserveIndex (dict, dict->list->count + 1);
+        if (ret == HPDF_OK)
+            ret = HPDF_List_Add (dict->list, element);
 
-        ret = HPDF_List_Add (dict->list, element);
         if (ret != HPDF_OK) {
             if (!(header->obj_id & HPDF_OTYPE_INDIRECT))
                 HPDF_Obj_Free (dict->mmgr, obj);
@@ -342,6 +385,9 @@ HPDF_Dict_Add  (HPDF_Dict        dict,
 
             return HPDF_Error_GetCode (dict->error);
         }
+
+        if (dict->index)
+            IndexInsert (dict, element);
     }
 
     if (header->obj_id & HPDF_OTYPE_INDIRECT) {
@@ -451,12 +497,128 @@ HPDF_Dict_GetItem  (HPDF_Dict        dict,
 }
 
 
+/*
+ *  the hash index is built when a dictionary gets HPDF_DICT_INDEX_THRESHOLD
+ *  elements. it is an open-addressing table (linear probing) of pointers
+ *  to the elements of dict->list, at most half full.
+ */
+
+static HPDF_UINT32
+HashKey  (const char  *key)
+{
+    /* FNV-1a */
+    HPDF_UINT32 hash = 2166136261u;
+
+    while (*key) {
+        hash ^= (HPDF_BYTE)*key++;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+
+static HPDF_STATUS
+ReserveIndex  (HPDF_Dict  dict,
+               HPDF_UINT  count)
+{
+    HPDF_DictElement *index;
+    HPDF_UINT size;
+    HPDF_UINT i;
+
+    if (count < HPDF_DICT_INDEX_THRESHOLD || count * 2 <= dict->index_size)
+        return HPDF_OK;
+
+    size = dict->index_size ? dict->index_size : HPDF_DICT_INDEX_THRESHOLD;
+    while (count * 2 > size)
+        size *= 2;
+
+    index = (HPDF_DictElement *)HPDF_GetMem (dict->mmgr,
+            sizeof(HPDF_DictElement) * size);
+    if (!index)
+        return HPDF_Error_GetCode (dict->error);
+
+    HPDF_MemSet (index, 0, sizeof(HPDF_DictElement) * size);
+
+    if (dict->index)
+        HPDF_FreeMem (dict->mmgr, dict->index);
+
+    dict->index = index;
+    dict->index_size = size;
+
+    for (i = 0; i < dict->list->count; i++)
+        IndexInsert (dict, (HPDF_DictElement)HPDF_List_ItemAt (dict->list, i));
+
+    return HPDF_OK;
+}
+
+
+static void
+IndexInsert  (HPDF_Dict         dict,
+              HPDF_DictElement  element)
+{
+    HPDF_UINT mask = dict->index_size - 1;
+    HPDF_UINT i = element->hash & mask;
+
+    while (dict->index[i])
+        i = (i + 1) & mask;
+
+    dict->index[i] = element;
+}
+
+
+static void
+IndexRemove  (HPDF_Dict         dict,
+              HPDF_DictElement  element)
+{
+    HPDF_UINT mask = dict->index_size - 1;
+    HPDF_UINT i = element->hash & mask;
+    HPDF_UINT j;
+
+    while (dict->index[i] != element)
+        i = (i + 1) & mask;
+
+    /* move back the elements of the probe sequence instead of leaving a
+       deleted mark, so that lookups can stop at the first empty slot */
+    j = i;
+    for (;;) {
+        HPDF_UINT home;
+
+        j = (j + 1) & mask;
+        if (!dict->index[j])
+            break;
+
+        home = dict->index[j]->hash & mask;
+        if ((i <= j) ? (home <= i || home > j) : (home <= i && home > j)) {
+            dict->index[i] = dict->index[j];
+            i = j;
+        }
+    }
+
+    dict->index[i] = NULL;
+}
+
+
 HPDF_DictElement
 GetElement  (HPDF_Dict        dict,
              const char  *key)
 {
     HPDF_UINT i;
 
+    if (dict->index) {
+        HPDF_UINT mask = dict->index_size - 1;
+        HPDF_UINT32 hash = HashKey (key);
+
+        for (i = hash & mask; dict->index[i]; i = (i + 1) & mask) {
+            HPDF_DictElement element = dict->index[i];
+
+            if (element->hash == hash && HPDF_StrCmp (key, element->key) == 0)
+                return element;
+        }
+
+        return NULL;
+    }
+
     for (i = 0; i < dict->list->count; i++) {
         HPDF_DictElement element =
                 (HPDF_DictElement)HPDF_List_ItemAt (dict->list, i);
@@ -473,23 +635,20 @@ HPDF_STATUS
 HPDF_Dict_RemoveElement  (HPDF_Dict        dict,
                           const char  *key)
 {
-    HPDF_UINT i;
+    HPDF_DictElement element = GetElement (dict, key);
 
-    for (i = 0; i < dict->list->count; i++) {
-        HPDF_DictElement element =
-                (HPDF_DictElement)HPDF_List_ItemAt (dict->list, i);
+    if (!element)
+        return HPDF_DICT_ITEM_NOT_FOUND;
 
-        if (HPDF_StrCmp (key, element->key) == 0) {
-            HPDF_List_Remove (dict->list, element);
+    if (dict->index)
+        IndexRemove (dict, element);
 
-            HPDF_Obj_Free (dict->mmgr, element->value);
-            HPDF_FreeMem (dict->mmgr, element);
+    HPDF_List_Remove (dict->list, element);
 
-            return HPDF_OK;
-        }
-    }
+    HPDF_Obj_Free (dict->mmgr, element->value);
+    HPDF_FreeMem (dict->mmgr, element);
 
-    return HPDF_DICT_ITEM_NOT_FOUND;
+    return HPDF_OK;
 }
 
 const char*
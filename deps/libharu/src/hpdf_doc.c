@@ -64,9 +64,15 @@ CleanupFontDefList (HPDF_Doc  pdf);
 static HPDF_Dict
 GetInfo  (HPDF_Doc  pdf);
 
+static HPDF_STATUS
+ReserveKids  (HPDF_Doc    pdf,
+              HPDF_Pages  pages,
+              HPDF_UINT   count);
+
 static HPDF_STATUS
 InternalSaveToStream  (HPDF_Doc      pdf,
-                       HPDF_Stream   stream);
+                       HPDF_Stream   stream,
+                       HPDF_BOOL     write_header);
 
 static const char*
 LoadType1FontFromStream (HPDF_Doc     pdf,
@@ -88,6 +94,12 @@ LoadTTFontFromStream2 (HPDF_Doc         pdf,
                        HPDF_BOOL        embedding,
                        const char      *file_name);
 
+
+static const char*
+RegisterTTFontDef (HPDF_Doc         pdf,
+                   HPDF_FontDef     def,
+                   HPDF_BOOL        embedding);
+
 /*---------------------------------------------------------------------------*/
 
 HPDF_EXPORT(const char *)
@@ -142,6 +154,47 @@ HPDF_New  (HPDF_Error_Handler    user_error_fn,
 }
 
 
+static HPDF_Doc
+NewDocument  (HPDF_MMgr            mmgr,
+              HPDF_Error           tmp_error,
+              HPDF_Error_Handler   user_error_fn)
+{
+    HPDF_Doc pdf;
+
+    /* now create pdf_doc object */
+    pdf = HPDF_GetMem (mmgr, sizeof (HPDF_Doc_Rec));
+    if (!pdf) {
+        HPDF_MMgr_Free (mmgr);
+        HPDF_CheckError (tmp_error);
+        return NULL;
+    }
+
+    HPDF_MemSet (pdf, 0, sizeof (HPDF_Doc_Rec));
+    pdf->sig_bytes = HPDF_SIG_BYTES;
+    pdf->mmgr = mmgr;
+    pdf->mmgr_mark = HPDF_MMgr_GetMark (mmgr);
+    pdf->pdf_version = HPDF_VER_13;
+    pdf->compression_mode = HPDF_COMP_NONE;
+
+    /* copy the data of temporary-error object to the one which is
+       included in pdf_doc object */
+    pdf->error = *tmp_error;
+
+    /* switch the error-object of memory-manager */
+    mmgr->error = &pdf->error;
+
+    if (HPDF_NewDoc (pdf) != HPDF_OK) {
+        HPDF_Free (pdf);
+        HPDF_CheckError (tmp_error);
+        return NULL;
+    }
+
+    pdf->error.error_fn = user_error_fn;
+
+    return pdf;
+}
+
+
 HPDF_EXPORT(HPDF_Doc)
 HPDF_NewEx  (HPDF_Error_Handler    user_error_fn,
              HPDF_Alloc_Func       user_alloc_fn,
@@ -149,7 +202,6 @@ HPDF_NewEx  (HPDF_Error_Handler    user_error_fn,
              HPDF_UINT             mem_pool_buf_size,
              void                 *user_data)
 {
-    HPDF_Doc pdf;
     HPDF_MMgr mmgr;
     HPDF_Error_Rec tmp_error;
 
@@ -166,36 +218,42 @@ HPDF_NewEx  (HPDF_Error_Handler    user_error_fn,
         return NULL;
     }
 
-    /* now create pdf_doc object */
-    pdf = HPDF_GetMem (mmgr, sizeof (HPDF_Doc_Rec));
-    if (!pdf) {
-        HPDF_MMgr_Free (mmgr);
-        HPDF_CheckError (&tmp_error);
-        return NULL;
-    }
+    return NewDocument (mmgr, &tmp_error, user_error_fn);
+}
 
-    HPDF_MemSet (pdf, 0, sizeof (HPDF_Doc_Rec));
-    pdf->sig_bytes = HPDF_SIG_BYTES;
-    pdf->mmgr = mmgr;
-    pdf->pdf_version = HPDF_VER_13;
-    pdf->compression_mode = HPDF_COMP_NONE;
 
-    /* copy the data of temporary-error object to the one which is
-       included in pdf_doc object */
-    pdf->error = tmp_error;
+/*
+ *  HPDF_NewWithAllocator
+ *
+ *  same as HPDF_NewEx, but alloc_fn and free_fn receive alloc_data, so
+ *  that the memory of a document can come from an allocator object of the
+ *  application. with mem_pool_buf_size the allocator is asked only for
+ *  the (growing) nodes of the memory pool.
+ *
+ */
+HPDF_EXPORT(HPDF_Doc)
+HPDF_NewWithAllocator  (HPDF_Error_Handler   user_error_fn,
+                        HPDF_AllocEx_Func    alloc_fn,
+                        HPDF_FreeEx_Func     free_fn,
+                        void                *alloc_data,
+                        HPDF_UINT            mem_pool_buf_size,
+                        void                *user_data)
+{
+    HPDF_MMgr mmgr;
+    HPDF_Error_Rec tmp_error;
 
-    /* switch the error-object of memory-manager */
-    mmgr->error = &pdf->error;
+    HPDF_PTRACE ((" HPDF_NewWithAllocator\n"));
 
-    if (HPDF_NewDoc (pdf) != HPDF_OK) {
-        HPDF_Free (pdf);
+    HPDF_Error_Init (&tmp_error, user_data);
+
+    mmgr = HPDF_MMgr_NewEx (&tmp_error, mem_pool_buf_size, alloc_fn,
+            free_fn, alloc_data);
+    if (!mmgr) {
         HPDF_CheckError (&tmp_error);
         return NULL;
     }
 
-    pdf->error.error_fn = user_error_fn;
-
-    return pdf;
+    return NewDocument (mmgr, &tmp_error, user_error_fn);
 }
 
 
@@ -284,6 +342,54 @@ HPDF_NewDoc  (HPDF_Doc  pdf)
 }
 
 
+/*
+ *  HPDF_ResetDoc
+ *
+ *  discard the content of the document and start a new one in the same
+ *  document object. compression settings are kept.
+ *  without a memory pool this is HPDF_NewDoc: loaded font definitions and
+ *  encoders stay registered. with a memory pool everything allocated after
+ *  the document object, font definitions and encoders included, is
+ *  released at once and the nodes of the pool are used again by the next
+ *  document, so fonts and encodings have to be loaded again.
+ *
+ */
+HPDF_EXPORT(HPDF_STATUS)
+HPDF_ResetDoc  (HPDF_Doc  pdf)
+{
+    HPDF_BOOL compression_mode;
+    HPDF_UINT text_flate;
+    HPDF_UINT image_flate;
+    HPDF_UINT metadata_flate;
+    HPDF_UINT compression_threads;
+
+    HPDF_PTRACE ((" HPDF_ResetDoc\n"));
+
+    if (!HPDF_Doc_Validate (pdf))
+        return HPDF_DOC_INVALID_OBJECT;
+
+    if (!pdf->mmgr->mpool)
+        return HPDF_NewDoc (pdf);
+
+    compression_mode = pdf->compression_mode;
+    text_flate = pdf->text_flate;
+    image_flate = pdf->image_flate;
+    metadata_flate = pdf->metadata_flate;
+    compression_threads = pdf->compression_threads;
+
+    HPDF_FreeDocAll (pdf);
+    HPDF_MMgr_Release (pdf->mmgr, pdf->mmgr_mark);
+
+    pdf->compression_mode = compression_mode;
+    pdf->text_flate = text_flate;
+    pdf->image_flate = image_flate;
+    pdf->metadata_flate = metadata_flate;
+    pdf->compression_threads = compression_threads;
+
+    return HPDF_NewDoc (pdf);
+}
+
+
 HPDF_EXPORT(void)
 HPDF_FreeDoc  (HPDF_Doc  pdf)
 {
@@ -332,6 +438,12 @@ HPDF_FreeDoc  (HPDF_Doc  pdf)
             pdf->stream = NULL;
         }
 
+        if (pdf->progressive_stream) {
+            HPDF_Stream_Free (pdf->progressive_stream);
+            pdf->progressive_stream = NULL;
+        }
+        pdf->progressive_used = HPDF_FALSE;
+
         pdf->pdfa_type = HPDF_PDFA_NON_PDFA;
         if (pdf->xmp_extensions) {
             HPDF_PDFA_ClearXmpExtensions(pdf);
@@ -357,12 +469,34 @@ HPDF_FreeDocAll  (HPDF_Doc  pdf)
             FreeEncoderList (pdf);
 
         pdf->compression_mode = HPDF_COMP_NONE;
+        pdf->text_flate = 0;
+        pdf->image_flate = 0;
+        pdf->metadata_flate = 0;
+        pdf->compression_threads = 0;
 
         HPDF_Error_Reset (&pdf->error);
     }
 }
 
 
+/* make room for count more kids in the pages node */
+static HPDF_STATUS
+ReserveKids  (HPDF_Doc    pdf,
+              HPDF_Pages  pages,
+              HPDF_UINT   count)
+{
+    HPDF_Array kids = (HPDF_Array)HPDF_Dict_GetItem (pages, "Kids",
+            HPDF_OCLASS_ARRAY);
+
+    HPDF_PTRACE ((" ReserveKids\n"));
+
+    if (!kids)
+        return HPDF_SetError (&pdf->error, HPDF_PAGES_MISSING_KIDS_ENTRY, 0);
+
+    return HPDF_List_Reserve (kids->list, kids->list->count + count);
+}
+
+
 HPDF_EXPORT(HPDF_STATUS)
 HPDF_SetPagesConfiguration  (HPDF_Doc    pdf,
                              HPDF_UINT   page_per_pages)
@@ -387,6 +521,55 @@ HPDF_SetPagesConfiguration  (HPDF_Doc    pdf,
 
     pdf->page_per_pages = page_per_pages;
 
+    /* the node is filled up to page_per_pages before the next one is added */
+    if (page_per_pages && ReserveKids (pdf, pdf->cur_pages,
+                page_per_pages < HPDF_MAX_KIDS_RESERVE ? page_per_pages :
+                HPDF_MAX_KIDS_RESERVE) != HPDF_OK)
+        return HPDF_CheckError (&pdf->error);
+
+    return HPDF_OK;
+}
+
+
+/*
+ *  HPDF_ReservePages
+ *
+ *  page_count :  Number of pages the application expects to add.
+ *
+ *  size the page list, the Kids array of the current pages node and the
+ *  cross-reference table at once when the size of the document is known,
+ *  so that adding the pages does not resize them. the value is a hint:
+ *  more or fewer pages may be added afterwards.
+ */
+HPDF_EXPORT(HPDF_STATUS)
+HPDF_ReservePages  (HPDF_Doc    pdf,
+                    HPDF_UINT   page_count)
+{
+    HPDF_UINT kids_count = page_count;
+
+    HPDF_PTRACE ((" HPDF_ReservePages\n"));
+
+    if (!HPDF_HasDoc (pdf))
+        return HPDF_INVALID_DOCUMENT;
+
+    if (page_count > HPDF_LIMIT_MAX_ARRAY)
+        return HPDF_RaiseError (&pdf->error, HPDF_INVALID_PARAMETER, 0);
+
+    if (HPDF_List_Reserve (pdf->page_list, pdf->page_list->count +
+                page_count) != HPDF_OK)
+        return HPDF_CheckError (&pdf->error);
+
+    if (pdf->page_per_pages && pdf->cur_page_num + kids_count >
+            pdf->page_per_pages)
+        kids_count = pdf->page_per_pages - pdf->cur_page_num;
+
+    if (ReserveKids (pdf, pdf->cur_pages, kids_count) != HPDF_OK)
+        return HPDF_CheckError (&pdf->error);
+
+    if (HPDF_Xref_Reserve (pdf->xref, page_count *
+                HPDF_PAGE_OBJECTS_NUM) != HPDF_OK)
+        return HPDF_CheckError (&pdf->error);
+
     return HPDF_OK;
 }
 
@@ -621,7 +804,8 @@ HPDF_Doc_PrepareEncryption  (HPDF_Doc   pdf)
 
 static HPDF_STATUS
 InternalSaveToStream  (HPDF_Doc      pdf,
-                       HPDF_Stream   stream)
+                       HPDF_Stream   stream,
+                       HPDF_BOOL     write_header)
 {
     HPDF_STATUS ret;
 
@@ -629,13 +813,19 @@ InternalSaveToStream  (HPDF_Doc      pdf,
     if (pdf->pdfa_type != HPDF_PDFA_NON_PDFA && (ret = HPDF_PDFA_AddXmpMetadata(pdf)) != HPDF_OK)
         return ret;
 
-    if ((ret = WriteHeader (pdf, stream)) != HPDF_OK)
+    /* header of progressive save is written by HPDF_BeginProgressiveSave */
+    if (write_header && (ret = WriteHeader (pdf, stream)) != HPDF_OK)
         return ret;
 
     /* prepare trailer */
     if ((ret = PrepareTrailer (pdf)) != HPDF_OK)
         return ret;
 
+    /* deflate the streams on worker threads, they are written in order */
+    if (pdf->compression_threads > 1 && (ret = HPDF_Xref_DeflateStreams (
+                    pdf->xref, pdf->compression_threads)) != HPDF_OK)
+        return ret;
+
     /* prepare encryption */
     if (pdf->encrypt_on) {
         HPDF_Encrypt e= HPDF_EncryptDict_GetAttr (pdf->encrypt_dict);
@@ -663,6 +853,9 @@ HPDF_SaveToStream  (HPDF_Doc   pdf)
     if (!HPDF_HasDoc (pdf))
         return HPDF_INVALID_DOCUMENT;
 
+    if (pdf->progressive_used)
+        return HPDF_RaiseError (&pdf->error, HPDF_INVALID_OPERATION, 0);
+
     if (!pdf->stream)
         pdf->stream = HPDF_MemStream_New (pdf->mmgr, HPDF_STREAM_BUF_SIZ);
 
@@ -671,7 +864,7 @@ HPDF_SaveToStream  (HPDF_Doc   pdf)
 
     HPDF_MemStream_FreeData (pdf->stream);
 
-    if (InternalSaveToStream (pdf, pdf->stream) != HPDF_OK)
+    if (InternalSaveToStream (pdf, pdf->stream, HPDF_TRUE) != HPDF_OK)
         return HPDF_CheckError (&pdf->error);
 
     return HPDF_OK;
@@ -692,13 +885,16 @@ HPDF_GetContents   (HPDF_Doc   pdf,
         return HPDF_INVALID_DOCUMENT;
     }
 
+    if (pdf->progressive_used)
+        return HPDF_RaiseError (&pdf->error, HPDF_INVALID_OPERATION, 0);
+
     stream = HPDF_MemStream_New (pdf->mmgr, HPDF_STREAM_BUF_SIZ);
 
     if (!stream) {
         return HPDF_CheckError (&pdf->error);
     }
 
-    if (InternalSaveToStream (pdf, stream) != HPDF_OK) {
+    if (InternalSaveToStream (pdf, stream, HPDF_TRUE) != HPDF_OK) {
         HPDF_Stream_Free (stream);
         return HPDF_CheckError (&pdf->error);
     }
@@ -778,11 +974,14 @@ HPDF_SaveToFile  (HPDF_Doc     pdf,
     if (!HPDF_HasDoc (pdf))
         return HPDF_INVALID_DOCUMENT;
 
+    if (pdf->progressive_used)
+        return HPDF_RaiseError (&pdf->error, HPDF_INVALID_OPERATION, 0);
+
     stream = HPDF_FileWriter_New (pdf->mmgr, file_name);
     if (!stream)
         return HPDF_CheckError (&pdf->error);
 
-    InternalSaveToStream (pdf, stream);
+    InternalSaveToStream (pdf, stream, HPDF_TRUE);
 
     HPDF_Stream_Free (stream);
 
@@ -790,6 +989,77 @@ HPDF_SaveToFile  (HPDF_Doc     pdf,
 }
 
 
+HPDF_EXPORT(HPDF_STATUS)
+HPDF_BeginProgressiveSave  (HPDF_Doc     pdf,
+                            const char  *file_name)
+{
+    HPDF_Stream stream;
+
+    HPDF_PTRACE ((" HPDF_BeginProgressiveSave\n"));
+
+    if (!HPDF_HasDoc (pdf))
+        return HPDF_INVALID_DOCUMENT;
+
+    /* flushed objects are written without encryption */
+    if (pdf->progressive_used || pdf->encrypt_on)
+        return HPDF_RaiseError (&pdf->error, HPDF_INVALID_OPERATION, 0);
+
+    stream = HPDF_FileWriter_New (pdf->mmgr, file_name);
+    if (!stream)
+        return HPDF_CheckError (&pdf->error);
+
+    /* the version written here can not be raised later */
+    if (WriteHeader (pdf, stream) != HPDF_OK) {
+        HPDF_Stream_Free (stream);
+        return HPDF_CheckError (&pdf->error);
+    }
+
+    pdf->progressive_stream = stream;
+    pdf->progressive_used = HPDF_TRUE;
+
+    return HPDF_OK;
+}
+
+
+HPDF_EXPORT(HPDF_STATUS)
+HPDF_FlushPage  (HPDF_Doc   pdf,
+                 HPDF_Page  page)
+{
+    HPDF_PTRACE ((" HPDF_FlushPage\n"));
+
+    if (!HPDF_HasDoc (pdf))
+        return HPDF_INVALID_DOCUMENT;
+
+    if (!pdf->progressive_stream || pdf->encrypt_on)
+        return HPDF_RaiseError (&pdf->error, HPDF_INVALID_OPERATION, 0);
+
+    if (HPDF_Page_Flush (page, pdf->progressive_stream) != HPDF_OK)
+        return HPDF_CheckError (&pdf->error);
+
+    return HPDF_OK;
+}
+
+
+HPDF_EXPORT(HPDF_STATUS)
+HPDF_EndProgressiveSave  (HPDF_Doc  pdf)
+{
+    HPDF_PTRACE ((" HPDF_EndProgressiveSave\n"));
+
+    if (!HPDF_HasDoc (pdf))
+        return HPDF_INVALID_DOCUMENT;
+
+    if (!pdf->progressive_stream || pdf->encrypt_on)
+        return HPDF_RaiseError (&pdf->error, HPDF_INVALID_OPERATION, 0);
+
+    InternalSaveToStream (pdf, pdf->progressive_stream, HPDF_FALSE);
+
+    HPDF_Stream_Free (pdf->progressive_stream);
+    pdf->progressive_stream = NULL;
+
+    return HPDF_CheckError (&pdf->error);
+}
+
+
 HPDF_EXPORT(HPDF_Page)
 HPDF_GetCurrentPage  (HPDF_Doc   pdf)
 {
@@ -896,6 +1166,13 @@ HPDF_AddPage  (HPDF_Doc  pdf)
             if (!pdf->cur_pages)
                 return NULL;
             pdf->cur_page_num = 0;
+
+            if (ReserveKids (pdf, pdf->cur_pages,
+                        pdf->page_per_pages < HPDF_MAX_KIDS_RESERVE ?
+                        pdf->page_per_pages : HPDF_MAX_KIDS_RESERVE) != HPDF_OK) {
+                HPDF_CheckError (&pdf->error);
+                return NULL;
+            }
         }
     }
 
@@ -918,7 +1195,8 @@ HPDF_AddPage  (HPDF_Doc  pdf)
     pdf->cur_page = page;
 
     if (pdf->compression_mode & HPDF_COMP_TEXT)
-        HPDF_Page_SetFilter (page, HPDF_STREAM_FILTER_FLATE_DECODE);
+        HPDF_Page_SetFilter (page, HPDF_STREAM_FILTER_FLATE_DECODE |
+                pdf->text_flate);
 
     pdf->cur_page_num++;
 
@@ -999,7 +1277,8 @@ HPDF_InsertPage  (HPDF_Doc    pdf,
     }
 
     if (pdf->compression_mode & HPDF_COMP_TEXT)
-        HPDF_Page_SetFilter (page, HPDF_STREAM_FILTER_FLATE_DECODE);
+        HPDF_Page_SetFilter (page, HPDF_STREAM_FILTER_FLATE_DECODE |
+                pdf->text_flate);
 
     return page;
 }
@@ -1409,7 +1688,7 @@ HPDF_GetFont  (HPDF_Doc          pdf,
         HPDF_CheckError (&pdf->error);
 
     if (font && (pdf->compression_mode & HPDF_COMP_METADATA))
-        font->filter = HPDF_STREAM_FILTER_FLATE_DECODE;
+        font->filter = HPDF_STREAM_FILTER_FLATE_DECODE | pdf->metadata_flate;
 
     return font;
 }
@@ -1497,7 +1776,7 @@ HPDF_GetTTFontDefFromFile (HPDF_Doc      pdf,
     HPDF_PTRACE ((" HPDF_GetTTFontDefFromFile\n"));
 
     /* create file stream */
-    font_data = HPDF_FileReader_New (pdf->mmgr, file_name);
+    font_data = HPDF_MappedFileReader_New (pdf->mmgr, file_name);
 
     if (HPDF_Stream_Validate (font_data)) {
         def = HPDF_TTFontDef_Load (pdf->mmgr, font_data, embedding);
@@ -1523,7 +1802,7 @@ HPDF_LoadTTFontFromFile (HPDF_Doc         pdf,
         return NULL;
 
     /* create file stream */
-    font_data = HPDF_FileReader_New (pdf->mmgr, file_name);
+    font_data = HPDF_MappedFileReader_New (pdf->mmgr, file_name);
 
     if (HPDF_Stream_Validate (font_data)) {
         ret = LoadTTFontFromStream (pdf, font_data, embedding, file_name);
@@ -1537,6 +1816,67 @@ HPDF_LoadTTFontFromFile (HPDF_Doc         pdf,
 }
 
 
+/**
+* @brief Load and parse a TrueType font once for use by any number of documents.
+* @param[in] file_name Filename of the TrueType font file.
+* @ret The shared font, NULL if the file cannot be read or parsed.
+* The shared font is not modified by documents, so it may be used from
+* several threads at once. It must outlive every document it was loaded into.
+*/
+HPDF_EXPORT(HPDF_SharedTTFont)
+HPDF_NewSharedTTFont (const char      *file_name)
+{
+    HPDF_PTRACE ((" HPDF_NewSharedTTFont\n"));
+
+    return HPDF_SharedTTFont_New (file_name);
+}
+
+
+HPDF_EXPORT(void)
+HPDF_FreeSharedTTFont (HPDF_SharedTTFont  font)
+{
+    HPDF_PTRACE ((" HPDF_FreeSharedTTFont\n"));
+
+    if (HPDF_SharedTTFont_Validate (font))
+        HPDF_SharedTTFont_Dispose (font);
+}
+
+
+/**
+* @brief Load a shared TrueType font into the document.
+* @param[in] font The shared font (HPDF_NewSharedTTFont).
+* @param[in] embedding Whether to embed the font in the document.
+* @ret The font name, the same as HPDF_LoadTTFontFromFile returns.
+* The font file is neither read nor parsed again: the document only keeps
+* the set of glyphs it uses.
+*/
+HPDF_EXPORT(const char*)
+HPDF_LoadSharedTTFont (HPDF_Doc           pdf,
+                       HPDF_SharedTTFont  font,
+                       HPDF_BOOL          embedding)
+{
+    const char *ret;
+
+    HPDF_PTRACE ((" HPDF_LoadSharedTTFont\n"));
+
+    if (!HPDF_HasDoc (pdf))
+        return NULL;
+
+    if (!HPDF_SharedTTFont_Validate (font)) {
+        HPDF_RaiseError (&pdf->error, HPDF_INVALID_PARAMETER, 0);
+        return NULL;
+    }
+
+    ret = RegisterTTFontDef (pdf,
+            HPDF_TTFontDef_NewShared (pdf->mmgr, font, embedding), embedding);
+
+    if (!ret)
+        HPDF_CheckError (&pdf->error);
+
+    return ret;
+}
+
+
 static const char*
 LoadTTFontFromStream (HPDF_Doc         pdf,
                       HPDF_Stream      font_data,
@@ -1549,6 +1889,18 @@ LoadTTFontFromStream (HPDF_Doc         pdf,
     HPDF_UNUSED (file_name);
 
     def = HPDF_TTFontDef_Load (pdf->mmgr, font_data, embedding);
+
+    return RegisterTTFontDef (pdf, def, embedding);
+}
+
+
+static const char*
+RegisterTTFontDef (HPDF_Doc         pdf,
+                   HPDF_FontDef     def,
+                   HPDF_BOOL        embedding)
+{
+    HPDF_PTRACE ((" RegisterTTFontDef\n"));
+
     if (def) {
         HPDF_FontDef  tmpdef = HPDF_Doc_FindFontDef (pdf, def->base_font);
         if (tmpdef) {
@@ -1607,7 +1959,7 @@ HPDF_LoadTTFontFromFile2 (HPDF_Doc         pdf,
         return NULL;
 
     /* create file stream */
-    font_data = HPDF_FileReader_New (pdf->mmgr, file_name);
+    font_data = HPDF_MappedFileReader_New (pdf->mmgr, file_name);
 
     if (HPDF_Stream_Validate (font_data)) {
         ret = LoadTTFontFromStream2 (pdf, font_data, index, embedding, file_name);
@@ -1734,7 +2086,7 @@ HPDF_LoadRawImageFromFile  (HPDF_Doc          pdf,
         HPDF_CheckError (&pdf->error);
 
     if (image && pdf->compression_mode & HPDF_COMP_IMAGE)
-        image->filter = HPDF_STREAM_FILTER_FLATE_DECODE;
+        image->filter = HPDF_STREAM_FILTER_FLATE_DECODE | pdf->image_flate;
 
     return image;
 }
@@ -1766,7 +2118,7 @@ HPDF_LoadRawImageFromMem  (HPDF_Doc           pdf,
         HPDF_CheckError (&pdf->error);
 
     if (image && pdf->compression_mode & HPDF_COMP_IMAGE) {
-        image->filter = HPDF_STREAM_FILTER_FLATE_DECODE;
+        image->filter = HPDF_STREAM_FILTER_FLATE_DECODE | pdf->image_flate;
     }
 
     return image;
@@ -2215,6 +2567,67 @@ HPDF_SetCompressionMode  (HPDF_Doc    pdf,
 }
 
 
+HPDF_EXPORT(HPDF_STATUS)
+HPDF_SetCompressionParams  (HPDF_Doc              pdf,
+                            HPDF_UINT             mode,
+                            HPDF_INT              level,
+                            HPDF_DeflateStrategy  strategy)
+{
+#ifdef LIBHPDF_HAVE_ZLIB
+    HPDF_UINT params;
+#endif /* LIBHPDF_HAVE_ZLIB */
+
+    HPDF_PTRACE ((" HPDF_SetCompressionParams\n"));
+
+    if (!HPDF_Doc_Validate (pdf))
+        return HPDF_INVALID_DOCUMENT;
+
+    if (mode != (mode & HPDF_COMP_MASK))
+        return HPDF_RaiseError (&pdf->error, HPDF_INVALID_COMPRESSION_MODE, 0);
+
+    if (level < HPDF_COMP_LEVEL_DEFAULT || level > HPDF_COMP_LEVEL_BEST ||
+            strategy < 0 || strategy >= HPDF_DEFLATE_STRATEGY_EOF)
+        return HPDF_RaiseError (&pdf->error, HPDF_INVALID_PARAMETER, 0);
+
+#ifdef LIBHPDF_HAVE_ZLIB
+    /* applies to the streams created after the call */
+    params = HPDF_STREAM_FILTER_FLATE_PARAMS (level, strategy);
+
+    if (mode & HPDF_COMP_TEXT)
+        pdf->text_flate = params;
+
+    if (mode & HPDF_COMP_IMAGE)
+        pdf->image_flate = params;
+
+    if (mode & HPDF_COMP_METADATA)
+        pdf->metadata_flate = params;
+
+    return HPDF_OK;
+
+#else /* LIBHPDF_HAVE_ZLIB */
+
+    return HPDF_INVALID_COMPRESSION_MODE;
+
+#endif /* LIBHPDF_HAVE_ZLIB */
+}
+
+
+HPDF_EXPORT(HPDF_STATUS)
+HPDF_SetCompressionThreads  (HPDF_Doc   pdf,
+                             HPDF_UINT  threads)
+{
+    HPDF_PTRACE ((" HPDF_SetCompressionThreads\n"));
+
+    if (!HPDF_Doc_Validate (pdf))
+        return HPDF_INVALID_DOCUMENT;
+
+    /* 0 and 1 deflate each stream on the calling thread as it is written */
+    pdf->compression_threads = threads;
+
+    return HPDF_OK;
+}
+
+
 HPDF_EXPORT(HPDF_STATUS)
 HPDF_GetError  (HPDF_Doc   pdf)
 {
@@ -162,11 +162,11 @@ LoadPngImageFromStream (HPDF_Doc      pdf,
                 delayed_loading);
 
     if (image && (pdf->compression_mode & HPDF_COMP_IMAGE)) {
-        image->filter = HPDF_STREAM_FILTER_FLATE_DECODE;
+        image->filter = HPDF_STREAM_FILTER_FLATE_DECODE | pdf->image_flate;
 
         // is there an alpha layer? then compress it also
         smask = HPDF_Dict_GetItem(image, "SMask", HPDF_OCLASS_DICT);
-        if (smask) smask->filter = HPDF_STREAM_FILTER_FLATE_DECODE;
+        if (smask) smask->filter = image->filter;
     }
 
     return image;
@@ -44,11 +44,11 @@ static HPDF_UNICODE
 UTF8_Encoder_ToUnicode_Func  (HPDF_Encoder   encoder,
                               HPDF_UINT16    code);
 
-static char *
+static HPDF_UINT
 UTF8_Encoder_EncodeText_Func  (HPDF_Encoder        encoder,
 			       const char         *text,
 			       HPDF_UINT           len,
-			       HPDF_UINT          *length);
+			       HPDF_BYTE          *out);
 
 static HPDF_STATUS
 UTF8_Init  (HPDF_Encoder    encoder);
@@ -172,36 +172,54 @@ UTF8_Encoder_ToUnicode_Func  (HPDF_Encoder   encoder,
     return val;
 }
 
-static char *
+/*
+ * Decodes the text in one pass, with the same rules as ByteType_Func and
+ * ToUnicode_Func: an invalid lead byte is skipped, an incomplete sequence
+ * at the end is dropped, characters outside UCS-2 become a space.
+ */
+static HPDF_UINT
 UTF8_Encoder_EncodeText_Func  (HPDF_Encoder        encoder,
 			       const char         *text,
 			       HPDF_UINT           len,
-			       HPDF_UINT          *length)
+			       HPDF_BYTE          *out)
 {
-    char *result = malloc(len * 2);
-    char *c = result;
-    HPDF_ParseText_Rec  parse_state;
-    HPDF_UINT i;
+    const HPDF_BYTE *p = (const HPDF_BYTE *)text;
+    const HPDF_BYTE *end = p + len;
+    HPDF_BYTE *c = out;
 
-    HPDF_Encoder_SetParseText (encoder, &parse_state,
-			       (const HPDF_BYTE *)text, len);
+    HPDF_UNUSED (encoder);
 
-    for (i = 0; i < len; i++) {
-	HPDF_UNICODE tmp_unicode;
-	HPDF_ByteType btype = HPDF_Encoder_ByteType (encoder, &parse_state);
+    while (p < end) {
+	HPDF_BYTE byte = *p++;
+	unsigned int val;
 
-	if (btype != HPDF_BYTE_TYPE_TRAIL) {
-	    tmp_unicode = HPDF_Encoder_ToUnicode (encoder, 0);
+	if (!(byte & 0x80)) {
+	    val = byte;
+	} else if ((byte & 0xe0) == 0xc0) {
+	    if (end - p < 1)
+		break;
+	    val = ((unsigned int)(byte & 0x1f) << 6) + (p[0] & 0x3f);
+	    p += 1;
+	} else if ((byte & 0xf0) == 0xe0) {
+	    if (end - p < 2)
+		break;
+	    val = ((unsigned int)(byte & 0xf) << 12) +
+		((unsigned int)(p[0] & 0x3f) << 6) + (p[1] & 0x3f);
+	    p += 2;
+	} else if ((byte & 0xf8) == 0xf0) {
+	    if (end - p < 3)
+		break;
+	    val = 32; // outside UCS-2
+	    p += 3;
+	} else {
+	    continue; // ERROR, skip this byte
+	}
 
-	    HPDF_UInt16Swap (&tmp_unicode);
-	    HPDF_MemCpy ((HPDF_BYTE *)c, (const HPDF_BYTE*)&tmp_unicode, 2);
-	    c += 2;
-        }
+	*c++ = (HPDF_BYTE)(val >> 8);
+	*c++ = (HPDF_BYTE)val;
     }
 
-    *length = (HPDF_UINT) (c - result);
-
-    return result;
+    return (HPDF_UINT) (c - out);
 }
 
 static HPDF_STATUS
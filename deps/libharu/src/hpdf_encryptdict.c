@@ -114,7 +114,7 @@ HPDF_EncryptDict_CreateID  (HPDF_EncryptDict  dict,
         if ((len = HPDF_StrLen (s, -1)) > 0)
             HPDF_MD5Update(&ctx, (const HPDF_BYTE *)s, len);
 
-        HPDF_MD5Update(&ctx, (const HPDF_BYTE *)&(xref->entries->count),
+        HPDF_MD5Update(&ctx, (const HPDF_BYTE *)&(xref->count),
                 sizeof(HPDF_UINT32));
 
     }
@@ -159,6 +159,29 @@ HPDF_Font_GetUnicodeWidth  (HPDF_Font       font,
 }
 
 
+HPDF_EXPORT(HPDF_STATUS)
+HPDF_Font_SetCMapDirectMode  (HPDF_Font  font,
+                              HPDF_BOOL  enabled)
+{
+    HPDF_FontAttr attr;
+
+    HPDF_PTRACE((" HPDF_Font_SetCMapDirectMode\n"));
+
+    if (!HPDF_Font_Validate(font))
+        return HPDF_INVALID_FONT;
+
+    attr = (HPDF_FontAttr)font->attr;
+
+    if (attr->fontdef->type != HPDF_FONTDEF_TYPE_TRUETYPE)
+        return HPDF_RaiseError (font->error, HPDF_INVALID_FONT, 0);
+
+    if (HPDF_TTFontDef_SetDirectCMap (attr->fontdef, enabled) != HPDF_OK)
+        return HPDF_CheckError (font->error);
+
+    return HPDF_OK;
+}
+
+
 HPDF_EXPORT(HPDF_Box)
 HPDF_Font_GetBBox  (HPDF_Font  font)
 {
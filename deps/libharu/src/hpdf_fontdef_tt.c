@@ -209,6 +209,16 @@ InitAttr (HPDF_FontDef  fontdef)
         if (attr->char_set)
             HPDF_FreeMem (fontdef->mmgr, attr->char_set);
 
+        if (attr->glyph_tbl.flgs)
+            HPDF_FreeMem (fontdef->mmgr, attr->glyph_tbl.flgs);
+
+        if (attr->stream)
+            HPDF_Stream_Free (attr->stream);
+
+        /* the tables of a shared font are freed with the shared font */
+        if (attr->source)
+            return;
+
         if (attr->h_metric)
             HPDF_FreeMem (fontdef->mmgr, attr->h_metric);
 
@@ -230,17 +240,14 @@ InitAttr (HPDF_FontDef  fontdef)
         if (attr->cmap.glyph_id_array)
             HPDF_FreeMem (fontdef->mmgr, attr->cmap.glyph_id_array);
 
+        if (attr->cmap.direct_map)
+            HPDF_FreeMem (fontdef->mmgr, attr->cmap.direct_map);
+
         if (attr->offset_tbl.table)
             HPDF_FreeMem (fontdef->mmgr, attr->offset_tbl.table);
 
-        if (attr->glyph_tbl.flgs)
-            HPDF_FreeMem (fontdef->mmgr, attr->glyph_tbl.flgs);
-
         if (attr->glyph_tbl.offsets)
             HPDF_FreeMem (fontdef->mmgr, attr->glyph_tbl.offsets);
-
-        if (attr->stream)
-            HPDF_Stream_Free (attr->stream);
     }
 }
 
@@ -337,6 +344,191 @@ HPDF_TTFontDef_Load2  (HPDF_MMgr     mmgr,
 }
 
 
+/*
+ *  HPDF_SharedTTFont_New
+ *
+ *  map the font file into memory and parse it once. the tables and
+ *  the data are never modified afterwards, so documents in any thread may
+ *  share them through HPDF_TTFontDef_NewShared. the glyph ids of all BMP
+ *  characters are looked up in advance for the same reason.
+ */
+HPDF_SharedTTFont
+HPDF_SharedTTFont_New  (const char  *file_name)
+{
+    HPDF_SharedTTFont font;
+    HPDF_MMgr mmgr;
+    HPDF_Error_Rec tmp_error;
+    HPDF_Stream file;
+    HPDF_Stream reader;
+
+    HPDF_PTRACE ((" HPDF_SharedTTFont_New\n"));
+
+    HPDF_Error_Init (&tmp_error, NULL);
+
+    mmgr = HPDF_MMgr_New (&tmp_error, 0, NULL, NULL);
+    if (!mmgr)
+        return NULL;
+
+    font = HPDF_GetMem (mmgr, sizeof (HPDF_SharedTTFont_Rec));
+    if (!font) {
+        HPDF_MMgr_Free (mmgr);
+        return NULL;
+    }
+
+    HPDF_MemSet (font, 0, sizeof (HPDF_SharedTTFont_Rec));
+    font->sig_bytes = HPDF_SHARED_TTFONT_SIG_BYTES;
+    font->mmgr = mmgr;
+    font->error = tmp_error;
+    mmgr->error = &font->error;
+
+    /* map the file, or load it where it cannot be mapped */
+    file = HPDF_MappedFileReader_New (mmgr, file_name);
+    if (!file) {
+        HPDF_SharedTTFont_Dispose (font);
+        return NULL;
+    }
+
+    if (file->type == HPDF_STREAM_BUFFER) {
+        font->file = file;
+        font->data = (HPDF_BYTE *)HPDF_BufferReader_GetBuf (file, &font->size);
+    } else {
+        font->size = HPDF_Stream_Size (file);
+        if (font->size > 0)
+            font->data = HPDF_GetMem (mmgr, font->size);
+
+        if (!font->data || HPDF_Stream_Read (file, font->data, &font->size) !=
+                HPDF_OK) {
+            HPDF_Stream_Free (file);
+            HPDF_SharedTTFont_Dispose (font);
+            return NULL;
+        }
+        HPDF_Stream_Free (file);
+    }
+
+    /* parse the tables */
+    reader = HPDF_BufferReader_New (mmgr, font->data, font->size);
+    if (!reader) {
+        HPDF_SharedTTFont_Dispose (font);
+        return NULL;
+    }
+
+    font->fontdef = HPDF_TTFontDef_Load (mmgr, reader, HPDF_FALSE);
+    if (!font->fontdef ||
+            HPDF_TTFontDef_SetDirectCMap (font->fontdef, HPDF_TRUE) !=
+            HPDF_OK) {
+        HPDF_SharedTTFont_Dispose (font);
+        return NULL;
+    }
+
+    return font;
+}
+
+
+void
+HPDF_SharedTTFont_Dispose  (HPDF_SharedTTFont  font)
+{
+    HPDF_MMgr mmgr;
+
+    HPDF_PTRACE ((" HPDF_SharedTTFont_Dispose\n"));
+
+    if (!font)
+        return;
+
+    mmgr = font->mmgr;
+
+    if (font->fontdef)
+        HPDF_FontDef_Free (font->fontdef);
+
+    if (font->file)
+        HPDF_Stream_Free (font->file);
+    else if (font->data)
+        HPDF_FreeMem (mmgr, font->data);
+
+    font->sig_bytes = 0;
+
+    HPDF_FreeMem (mmgr, font);
+    HPDF_MMgr_Free (mmgr);
+}
+
+
+HPDF_BOOL
+HPDF_SharedTTFont_Validate  (HPDF_SharedTTFont  font)
+{
+    if (!font || font->sig_bytes != HPDF_SHARED_TTFONT_SIG_BYTES)
+        return HPDF_FALSE;
+    else
+        return HPDF_TRUE;
+}
+
+
+/*
+ *  HPDF_TTFontDef_NewShared
+ *
+ *  create a fontdef which borrows the parsed tables of a shared font. it
+ *  only owns the flags of used glyphs and, when embedding, a reader over
+ *  the file data of the shared font. the shared font must stay alive until
+ *  the fontdef is freed.
+ */
+HPDF_FontDef
+HPDF_TTFontDef_NewShared  (HPDF_MMgr          mmgr,
+                           HPDF_SharedTTFont  font,
+                           HPDF_BOOL          embedding)
+{
+    HPDF_FontDef fontdef;
+    HPDF_TTFontDefAttr attr;
+    HPDF_TTFontDefAttr src_attr;
+    HPDF_FontDef_Rec rec;
+
+    HPDF_PTRACE ((" HPDF_TTFontDef_NewShared\n"));
+
+    fontdef = HPDF_TTFontDef_New (mmgr);
+    if (!fontdef)
+        return NULL;
+
+    attr = (HPDF_TTFontDefAttr)fontdef->attr;
+    src_attr = (HPDF_TTFontDefAttr)font->fontdef->attr;
+
+    /* metrics and names of the font */
+    rec = *fontdef;
+    *fontdef = *font->fontdef;
+    fontdef->mmgr = rec.mmgr;
+    fontdef->error = rec.error;
+    fontdef->clean_fn = rec.clean_fn;
+    fontdef->free_fn = rec.free_fn;
+    fontdef->descriptor = NULL;
+    fontdef->data = NULL;
+    fontdef->attr = attr;
+
+    /* parsed tables */
+    *attr = *src_attr;
+    attr->source = src_attr;
+    attr->char_set = NULL;
+    attr->stream = NULL;
+    attr->embedding = embedding;
+
+    attr->glyph_tbl.flgs = HPDF_GetMem (mmgr,
+            sizeof (HPDF_BYTE) * attr->num_glyphs);
+    if (!attr->glyph_tbl.flgs) {
+        HPDF_FontDef_Free (fontdef);
+        return NULL;
+    }
+
+    HPDF_MemSet (attr->glyph_tbl.flgs, 0,
+            sizeof (HPDF_BYTE) * attr->num_glyphs);
+    attr->glyph_tbl.flgs[0] = 1;
+
+    if (embedding) {
+        attr->stream = HPDF_BufferReader_New (mmgr, font->data, font->size);
+        if (!attr->stream) {
+            HPDF_FontDef_Free (fontdef);
+            return NULL;
+        }
+    }
+
+    return fontdef;
+}
+
+
 #ifdef HPDF_TTF_DEBUG
 static void
 DumpTable (HPDF_FontDef   fontdef)
@@ -588,6 +780,15 @@ GetUINT32 (HPDF_Stream         stream,
 {
     HPDF_STATUS ret;
     HPDF_UINT size = sizeof (HPDF_UINT32);
+    const HPDF_BYTE *p;
+
+    /* a font in memory is read in place */
+    if (stream->type == HPDF_STREAM_BUFFER &&
+            (p = HPDF_BufferReader_Read (stream, size)) != NULL) {
+        *value = (HPDF_UINT32)p[0] << 24 | (HPDF_UINT32)p[1] << 16 |
+                (HPDF_UINT32)p[2] << 8 | (HPDF_UINT32)p[3];
+        return HPDF_OK;
+    }
 
     ret = HPDF_Stream_Read (stream, (HPDF_BYTE *)value, &size);
     if (ret != HPDF_OK) {
@@ -607,6 +808,14 @@ GetUINT16 (HPDF_Stream         stream,
 {
     HPDF_STATUS ret;
     HPDF_UINT size = sizeof (HPDF_UINT16);
+    const HPDF_BYTE *p;
+
+    /* a font in memory is read in place */
+    if (stream->type == HPDF_STREAM_BUFFER &&
+            (p = HPDF_BufferReader_Read (stream, size)) != NULL) {
+        *value = (HPDF_UINT16)(p[0] << 8 | p[1]);
+        return HPDF_OK;
+    }
 
     ret = HPDF_Stream_Read (stream, (HPDF_BYTE *)value, &size);
     if (ret != HPDF_OK) {
@@ -626,6 +835,14 @@ GetINT16 (HPDF_Stream    stream,
 {
     HPDF_STATUS ret;
     HPDF_UINT size = sizeof (HPDF_INT16);
+    const HPDF_BYTE *p;
+
+    /* a font in memory is read in place */
+    if (stream->type == HPDF_STREAM_BUFFER &&
+            (p = HPDF_BufferReader_Read (stream, size)) != NULL) {
+        *value = (HPDF_INT16)(p[0] << 8 | p[1]);
+        return HPDF_OK;
+    }
 
     ret = HPDF_Stream_Read (stream, (HPDF_BYTE *)value, &size);
     if (ret != HPDF_OK) {
@@ -1135,36 +1352,28 @@ ParseCMAP_format4  (HPDF_FontDef  fontdef,
 }
 
 
-HPDF_UINT16
-HPDF_TTFontDef_GetGlyphid  (HPDF_FontDef   fontdef,
-                            HPDF_UINT16    unicode)
+/* glyph id of a character from the segments of cmap format 4 */
+static HPDF_UINT16
+GetGlyphidFormat4  (HPDF_TTFontDefAttr  attr,
+                    HPDF_UINT16         unicode)
 {
-    HPDF_TTFontDefAttr attr = (HPDF_TTFontDefAttr)fontdef->attr;
-    HPDF_UINT16 *pend_count = attr->cmap.end_count;
     HPDF_UINT seg_count = attr->cmap.seg_count_x2 / 2;
+    HPDF_UINT low = 0;
+    HPDF_UINT high = seg_count;
     HPDF_UINT i;
 
-    HPDF_PTRACE((" HPDF_TTFontDef_GetGlyphid\n"));
+    /* end_count is sorted: find the first segment with end_count >= unicode */
+    while (low < high) {
+        HPDF_UINT mid = (low + high) / 2;
 
-    /* format 0 */
-    if (attr->cmap.format == 0) {
-        unicode &= 0xFF;
-        return attr->cmap.glyph_id_array[unicode];
-    }
-
-    /* format 4 */
-    if (attr->cmap.seg_count_x2 == 0) {
-        HPDF_SetError (fontdef->error, HPDF_TTF_INVALID_CMAP, 0);
-        return 0;
+        if (attr->cmap.end_count[mid] < unicode)
+            low = mid + 1;
+        else
+            high = mid;
     }
+    i = low;
 
-    for (i = 0; i < seg_count; i++) {
-        if (unicode <= *pend_count)
-            break;
-        pend_count++;
-    }
-
-    if (attr->cmap.start_count[i] > unicode) {
+    if (i >= seg_count || attr->cmap.start_count[i] > unicode) {
         HPDF_PTRACE((" HPDF_TTFontDef_GetGlyphid undefined char(0x%04X)\n",
                     unicode));
         return 0;
@@ -1195,6 +1404,85 @@ HPDF_TTFontDef_GetGlyphid  (HPDF_FontDef   fontdef,
 }
 
 
+HPDF_UINT16
+HPDF_TTFontDef_GetGlyphid  (HPDF_FontDef   fontdef,
+                            HPDF_UINT16    unicode)
+{
+    HPDF_TTFontDefAttr attr = (HPDF_TTFontDefAttr)fontdef->attr;
+
+    HPDF_PTRACE((" HPDF_TTFontDef_GetGlyphid\n"));
+
+    /* format 0 */
+    if (attr->cmap.format == 0) {
+        unicode &= 0xFF;
+        return attr->cmap.glyph_id_array[unicode];
+    }
+
+    /* format 4 */
+    if (attr->cmap.direct_map)
+        return attr->cmap.direct_map[unicode];
+
+    if (attr->cmap.seg_count_x2 == 0) {
+        HPDF_SetError (fontdef->error, HPDF_TTF_INVALID_CMAP, 0);
+        return 0;
+    }
+
+    return GetGlyphidFormat4 (attr, unicode);
+}
+
+
+/*
+ *  HPDF_TTFontDef_SetDirectCMap
+ *
+ *  expand the segments of cmap format 4 into a table of 65536 glyph ids
+ *  (128KB), so that HPDF_TTFontDef_GetGlyphid becomes a single array read.
+ *  with enabled == HPDF_FALSE the table is released and the segments are
+ *  searched again.
+ *
+ */
+HPDF_STATUS
+HPDF_TTFontDef_SetDirectCMap  (HPDF_FontDef   fontdef,
+                               HPDF_BOOL      enabled)
+{
+    HPDF_TTFontDefAttr attr = (HPDF_TTFontDefAttr)fontdef->attr;
+    HPDF_UINT unicode;
+
+    HPDF_PTRACE((" HPDF_TTFontDef_SetDirectCMap\n"));
+
+    /* a shared font has the table already, it is only switched */
+    if (attr->source) {
+        attr->cmap.direct_map = enabled ? attr->source->cmap.direct_map : NULL;
+        return HPDF_OK;
+    }
+
+    if (!enabled) {
+        if (attr->cmap.direct_map) {
+            HPDF_FreeMem (fontdef->mmgr, attr->cmap.direct_map);
+            attr->cmap.direct_map = NULL;
+        }
+        return HPDF_OK;
+    }
+
+    /* format 0 is a direct table already */
+    if (attr->cmap.direct_map || attr->cmap.format == 0)
+        return HPDF_OK;
+
+    if (attr->cmap.seg_count_x2 == 0)
+        return HPDF_SetError (fontdef->error, HPDF_TTF_INVALID_CMAP, 0);
+
+    attr->cmap.direct_map = HPDF_GetMem (fontdef->mmgr,
+            sizeof(HPDF_UINT16) * 65536);
+    if (!attr->cmap.direct_map)
+        return HPDF_Error_GetCode (fontdef->error);
+
+    for (unicode = 0; unicode < 65536; unicode++)
+        attr->cmap.direct_map[unicode] = GetGlyphidFormat4 (attr,
+                (HPDF_UINT16)unicode);
+
+    return HPDF_OK;
+}
+
+
 HPDF_INT16
 HPDF_TTFontDef_GetCharWidth  (HPDF_FontDef   fontdef,
                               HPDF_UINT16    unicode)
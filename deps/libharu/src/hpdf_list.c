@@ -80,8 +80,16 @@ HPDF_List_Add  (HPDF_List  list,
     HPDF_PTRACE((" HPDF_List_Add\n"));
 
     if (list->count >= list->block_siz) {
-        HPDF_STATUS ret = Resize (list,
-                list->block_siz + list->items_per_block);
+        /* grow geometrically: appending N items copies O(N) pointers and
+           leaves at most as many superseded slots as the list holds, which
+           matters under mpool where HPDF_FreeMem does not release them */
+        HPDF_UINT new_size = list->block_siz * 2;
+        HPDF_STATUS ret;
+
+        if (new_size < list->block_siz + list->items_per_block)
+            new_size = list->block_siz + list->items_per_block;
+
+        ret = Resize (list, new_size);
 
         if (ret != HPDF_OK) {
             return ret;
@@ -93,6 +101,34 @@ HPDF_List_Add  (HPDF_List  list,
 }
 
 
+/*
+ *  HPDF_List_Reserve
+ *
+ *  list :  Pointer to a HPDF_List object.
+ *  count :  Number of items the list is expected to hold.
+ *
+ *  allocate the array of pointers at once when the final size is known,
+ *  so that adding the items does not resize it.
+ *
+ *  return:  If HPDF_List_Reserve success, it returns HPDF_OK.
+ *           HPDF_FAILD_TO_ALLOC_MEM is returned when the expansion of the
+ *           object list is failed.
+ *
+ */
+
+HPDF_STATUS
+HPDF_List_Reserve  (HPDF_List  list,
+                    HPDF_UINT  count)
+{
+    HPDF_PTRACE((" HPDF_List_Reserve\n"));
+
+    if (count <= list->block_siz)
+        return HPDF_OK;
+
+    return Resize (list, count);
+}
+
+
 /*
  *  HPDF_List_Insert
  *
@@ -39,17 +39,42 @@ static void HPDF_STDCALL
 InternalFreeMem  (void*  aptr);
 
 
-HPDF_MMgr
-HPDF_MMgr_New  (HPDF_Error       error,
-                HPDF_UINT        buf_size,
-                HPDF_Alloc_Func  alloc_fn,
-                HPDF_Free_Func   free_fn)
+static void*
+MMgr_Alloc  (HPDF_MMgr  mmgr,
+             HPDF_UINT  size)
 {
-    HPDF_MMgr mmgr;
+    if (mmgr->alloc_ex_fn)
+        return mmgr->alloc_ex_fn (mmgr->alloc_data, size);
 
-    HPDF_PTRACE((" HPDF_MMgr_New\n"));
+    return mmgr->alloc_fn (size);
+}
+
+
+static void
+MMgr_Release  (HPDF_MMgr  mmgr,
+               void       *aptr)
+{
+    if (mmgr->free_ex_fn)
+        mmgr->free_ex_fn (mmgr->alloc_data, aptr);
+    else
+        mmgr->free_fn (aptr);
+}
+
+
+static HPDF_MMgr
+MMgr_Create  (HPDF_Error         error,
+              HPDF_UINT          buf_size,
+              HPDF_Alloc_Func    alloc_fn,
+              HPDF_Free_Func     free_fn,
+              HPDF_AllocEx_Func  alloc_ex_fn,
+              HPDF_FreeEx_Func   free_ex_fn,
+              void              *alloc_data)
+{
+    HPDF_MMgr mmgr;
 
-    if (alloc_fn)
+    if (alloc_ex_fn && free_ex_fn)
+        mmgr = (HPDF_MMgr)alloc_ex_fn (alloc_data, sizeof(HPDF_MMgr_Rec));
+    else if (alloc_fn)
         mmgr = (HPDF_MMgr)alloc_fn (sizeof(HPDF_MMgr_Rec));
     else
         mmgr = (HPDF_MMgr)InternalGetMem (sizeof(HPDF_MMgr_Rec));
@@ -70,7 +95,18 @@ HPDF_MMgr_New  (HPDF_Error       error,
          *  used. if not, default function (maybe these will be "malloc" and
          *  "free") is used.
          */
-        if (alloc_fn && free_fn) {
+        mmgr->alloc_ex_fn = NULL;
+        mmgr->free_ex_fn = NULL;
+        mmgr->alloc_data = NULL;
+        mmgr->spare = NULL;
+
+        if (alloc_ex_fn && free_ex_fn) {
+            mmgr->alloc_ex_fn = alloc_ex_fn;
+            mmgr->free_ex_fn = free_ex_fn;
+            mmgr->alloc_data = alloc_data;
+            mmgr->alloc_fn = NULL;
+            mmgr->free_fn = NULL;
+        } else if (alloc_fn && free_fn) {
             mmgr->alloc_fn = alloc_fn;
             mmgr->free_fn = free_fn;
         } else {
@@ -88,15 +124,15 @@ HPDF_MMgr_New  (HPDF_Error       error,
         else {
             HPDF_MPool_Node node;
 
-            node = (HPDF_MPool_Node)mmgr->alloc_fn (sizeof(HPDF_MPool_Node_Rec) +
-                    buf_size);
+            node = (HPDF_MPool_Node)MMgr_Alloc (mmgr,
+                    sizeof(HPDF_MPool_Node_Rec) + buf_size);
 
             HPDF_PTRACE(("+%p mmgr-node-new\n", node));
 
             if (node == NULL) {
                 HPDF_SetError (error, HPDF_FAILED_TO_ALLOC_MEM, HPDF_NOERROR);
 
-                mmgr->free_fn(mmgr);
+                MMgr_Release (mmgr, mmgr);
                 mmgr = NULL;
             } else {
                 mmgr->mpool = node;
@@ -122,6 +158,33 @@ HPDF_MMgr_New  (HPDF_Error       error,
     return mmgr;
 }
 
+
+HPDF_MMgr
+HPDF_MMgr_New  (HPDF_Error       error,
+                HPDF_UINT        buf_size,
+                HPDF_Alloc_Func  alloc_fn,
+                HPDF_Free_Func   free_fn)
+{
+    HPDF_PTRACE((" HPDF_MMgr_New\n"));
+
+    return MMgr_Create (error, buf_size, alloc_fn, free_fn, NULL, NULL, NULL);
+}
+
+
+HPDF_MMgr
+HPDF_MMgr_NewEx  (HPDF_Error         error,
+                  HPDF_UINT          buf_size,
+                  HPDF_AllocEx_Func  alloc_fn,
+                  HPDF_FreeEx_Func   free_fn,
+                  void              *alloc_data)
+{
+    HPDF_PTRACE((" HPDF_MMgr_NewEx\n"));
+
+    return MMgr_Create (error, buf_size, NULL, NULL, alloc_fn, free_fn,
+            alloc_data);
+}
+
+
 void
 HPDF_MMgr_Free  (HPDF_MMgr  mmgr)
 {
@@ -132,6 +195,16 @@ HPDF_MMgr_Free  (HPDF_MMgr  mmgr)
     if (mmgr == NULL)
         return;
 
+    /* spare nodes are appended to the pool, then all nodes are deleted */
+    if (mmgr->spare) {
+        node = mmgr->spare;
+        while (node->next_node)
+            node = node->next_node;
+        node->next_node = mmgr->mpool;
+        mmgr->mpool = mmgr->spare;
+        mmgr->spare = NULL;
+    }
+
     node = mmgr->mpool;
 
     /* delete all nodes recursively */
@@ -140,7 +213,7 @@ HPDF_MMgr_Free  (HPDF_MMgr  mmgr)
         node = tmp->next_node;
 
         HPDF_PTRACE(("-%p mmgr-node-free\n", tmp));
-        mmgr->free_fn (tmp);
+        MMgr_Release (mmgr, tmp);
 
 #ifdef HPDF_MEM_DEBUG
         mmgr->free_cnt++;
@@ -157,7 +230,7 @@ HPDF_MMgr_Free  (HPDF_MMgr  mmgr)
 #endif
 
     HPDF_PTRACE(("-%p mmgr-free\n", mmgr));
-    mmgr->free_fn (mmgr);
+    MMgr_Release (mmgr, mmgr);
 }
 
 void*
@@ -169,21 +242,33 @@ HPDF_GetMem  (HPDF_MMgr  mmgr,
     if (mmgr->mpool) {
         HPDF_MPool_Node node = mmgr->mpool;
 
-#ifdef HPDF_ALINMENT_SIZ
-        size = (size + (HPDF_ALINMENT_SIZ - 1)) / HPDF_ALINMENT_SIZ;
-        size *= HPDF_ALINMENT_SIZ;
+#ifdef HPDF_ALIGNMENT_SIZE
+        size = (size + (HPDF_ALIGNMENT_SIZE - 1)) / HPDF_ALIGNMENT_SIZE;
+        size *= HPDF_ALIGNMENT_SIZE;
 #endif
 
         if (node->size - node->used_size >= size) {
             ptr = (HPDF_BYTE*)node->buf + node->used_size;
             node->used_size += size;
             return ptr;
+        } else if (mmgr->spare && mmgr->spare->size >= size) {
+            /* a node released by HPDF_MMgr_Release is used again first */
+            node = mmgr->spare;
+            mmgr->spare = node->next_node;
         } else {
-            HPDF_UINT tmp_buf_siz = (mmgr->buf_size < size) ?  size :
-                mmgr->buf_size;
+            HPDF_UINT tmp_buf_siz;
+
+            /* the pool grows geometrically: a large document needs a few
+             * big nodes instead of thousands of small ones */
+            if (mmgr->buf_size < HPDF_MAX_MPOOL_BUF_SIZ / 2)
+                mmgr->buf_size *= 2;
+            else if (mmgr->buf_size < HPDF_MAX_MPOOL_BUF_SIZ)
+                mmgr->buf_size = HPDF_MAX_MPOOL_BUF_SIZ;
 
-            node = (HPDF_MPool_Node)mmgr->alloc_fn (sizeof(HPDF_MPool_Node_Rec)
-                    + tmp_buf_siz);
+            tmp_buf_siz = (mmgr->buf_size < size) ?  size : mmgr->buf_size;
+
+            node = (HPDF_MPool_Node)MMgr_Alloc (mmgr,
+                    sizeof(HPDF_MPool_Node_Rec) + tmp_buf_siz);
             HPDF_PTRACE(("+%p mmgr-new-node\n", node));
 
             if (!node) {
@@ -201,7 +286,7 @@ HPDF_GetMem  (HPDF_MMgr  mmgr,
         node->buf = (HPDF_BYTE*)node + sizeof(HPDF_MPool_Node_Rec);
         ptr = node->buf;
     } else {
-        ptr = mmgr->alloc_fn (size);
+        ptr = MMgr_Alloc (mmgr, size);
         HPDF_PTRACE(("+%p mmgr-alloc_fn size=%u\n", ptr, size));
 
         if (ptr == NULL)
@@ -216,6 +301,48 @@ HPDF_GetMem  (HPDF_MMgr  mmgr,
     return ptr;
 }
 
+HPDF_MMgr_Mark
+HPDF_MMgr_GetMark  (HPDF_MMgr  mmgr)
+{
+    HPDF_MMgr_Mark mark;
+
+    mark.node = mmgr->mpool;
+    mark.used_size = mmgr->mpool ? mmgr->mpool->used_size : 0;
+
+    return mark;
+}
+
+
+void
+HPDF_MMgr_Release  (HPDF_MMgr       mmgr,
+                    HPDF_MMgr_Mark  mark)
+{
+    HPDF_MPool_Node node;
+
+    HPDF_PTRACE((" HPDF_MMgr_Release\n"));
+
+    if (!mmgr->mpool || !mark.node)
+        return;
+
+    /* the mark must belong to the pool */
+    node = mmgr->mpool;
+    while (node && node != mark.node)
+        node = node->next_node;
+
+    if (!node)
+        return;
+
+    while (mmgr->mpool != mark.node) {
+        node = mmgr->mpool;
+        mmgr->mpool = node->next_node;
+        node->next_node = mmgr->spare;
+        mmgr->spare = node;
+    }
+
+    mmgr->mpool->used_size = mark.used_size;
+}
+
+
 void
 HPDF_FreeMem  (HPDF_MMgr  mmgr,
                void       *aptr)
@@ -225,7 +352,7 @@ HPDF_FreeMem  (HPDF_MMgr  mmgr,
 
     if (!mmgr->mpool) {
         HPDF_PTRACE(("-%p mmgr-free-mem\n", aptr));
-        mmgr->free_fn(aptr);
+        MMgr_Release (mmgr, aptr);
 
 #ifdef HPDF_MEM_DEBUG
         mmgr->free_cnt++;
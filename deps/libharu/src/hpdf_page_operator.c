@@ -29,6 +29,19 @@ InternalWriteText  (HPDF_PageAttr    attr,
                     const char      *text);
 
 
+static HPDF_STATUS
+InternalWriteEncodedText  (HPDF_PageAttr    attr,
+                           HPDF_Encoder     encoder,
+                           const char      *text,
+                           HPDF_UINT        len);
+
+
+static HPDF_STATUS
+InternalWriteText2  (HPDF_PageAttr    attr,
+                     const char      *text,
+                     HPDF_UINT        len);
+
+
 static HPDF_STATUS
 InternalArc  (HPDF_Page    page,
               HPDF_REAL    x,
@@ -2355,12 +2368,88 @@ HPDF_Page_DrawImage  (HPDF_Page    page,
 }
 
 
+/*
+ *  length of the next piece of text to encode: at most HPDF_TEXT_DEFAULT_LEN
+ *  bytes ending on a UTF-8 sequence boundary. the length of a sequence is
+ *  taken from its lead byte, as the encoder takes it.
+ */
+static HPDF_UINT
+TextChunkLen  (const HPDF_BYTE  *text,
+               HPDF_UINT         len)
+{
+    HPDF_UINT n = 0;
+
+    if (len <= HPDF_TEXT_DEFAULT_LEN)
+        return len;
+
+    for (;;) {
+        HPDF_BYTE byte = text[n];
+        HPDF_UINT step = 1;
+
+        if ((byte & 0xe0) == 0xc0)
+            step = 2;
+        else if ((byte & 0xf0) == 0xe0)
+            step = 3;
+        else if ((byte & 0xf8) == 0xf0)
+            step = 4;
+
+        if (n + step > HPDF_TEXT_DEFAULT_LEN)
+            return n;
+
+        n += step;
+    }
+}
+
+
+/*
+ *  write the text of a Type0 font as a hex string of its codes.
+ *  the text is encoded in pieces of up to HPDF_TEXT_DEFAULT_LEN bytes into
+ *  a buffer on the stack (a piece gives at most two bytes of codes per
+ *  byte of text), so no memory is allocated however long the text is.
+ */
+static HPDF_STATUS
+InternalWriteEncodedText  (HPDF_PageAttr    attr,
+                           HPDF_Encoder     encoder,
+                           const char      *text,
+                           HPDF_UINT        len)
+{
+    HPDF_BYTE buf[HPDF_TEXT_DEFAULT_LEN * 2];
+    HPDF_UINT pos = 0;
+    HPDF_STATUS ret;
+
+    if ((ret = HPDF_Stream_WriteChar (attr->stream, '<')) != HPDF_OK)
+        return ret;
+
+    if (encoder->encode_text_fn == NULL) {
+        ret = HPDF_Stream_WriteBinary (attr->stream, (const HPDF_BYTE *)text,
+                len, NULL);
+    } else {
+        while (pos < len) {
+            HPDF_UINT chunk = TextChunkLen ((const HPDF_BYTE *)text + pos,
+                    len - pos);
+            HPDF_UINT length = (encoder->encode_text_fn)(encoder, text + pos,
+                    chunk, buf);
+
+            ret = HPDF_Stream_WriteBinary (attr->stream, buf, length, NULL);
+            if (ret != HPDF_OK)
+                break;
+
+            pos += chunk;
+        }
+    }
+
+    if (ret != HPDF_OK)
+        return ret;
+
+    return HPDF_Stream_WriteChar (attr->stream, '>');
+}
+
+
 static HPDF_STATUS
 InternalWriteText  (HPDF_PageAttr      attr,
                     const char        *text)
 {
     HPDF_FontAttr font_attr = (HPDF_FontAttr)attr->gstate->font->attr;
-    HPDF_STATUS ret;
 
     HPDF_PTRACE ((" InternalWriteText\n"));
 
@@ -2369,36 +2458,30 @@ InternalWriteText  (HPDF_PageAttr      attr,
         HPDF_Encoder encoder;
 	HPDF_UINT len;
 
-        if ((ret = HPDF_Stream_WriteStr (attr->stream, "<")) != HPDF_OK)
-            return ret;
-
         encoder = font_attr->encoder;
         len = HPDF_StrLen (text, HPDF_LIMIT_MAX_STRING_LEN);
 
-        if (encoder->encode_text_fn == NULL) {
-	    if ((ret = HPDF_Stream_WriteBinary (attr->stream, (HPDF_BYTE *)text,
-						len, NULL))
-		!= HPDF_OK)
-	        return ret;
-        } else {
-	    char *encoded;
-	    HPDF_UINT length;
+        return InternalWriteEncodedText (attr, encoder, text, len);
+    }
 
-	    encoded = (encoder->encode_text_fn)(encoder, text, len, &length);
+    return HPDF_Stream_WriteEscapeText (attr->stream, text);
+}
 
-	    ret = HPDF_Stream_WriteBinary (attr->stream, (HPDF_BYTE *)encoded,
-					   length, NULL);
 
-	    free(encoded);
+static HPDF_STATUS
+InternalWriteText2  (HPDF_PageAttr      attr,
+                     const char        *text,
+                     HPDF_UINT          len)
+{
+    HPDF_FontAttr font_attr = (HPDF_FontAttr)attr->gstate->font->attr;
 
-	    if (ret != HPDF_OK)
-                return ret;
-        }
+    HPDF_PTRACE ((" InternalWriteText2\n"));
 
-        return HPDF_Stream_WriteStr (attr->stream, ">");
-    }
+    if (font_attr->type == HPDF_FONT_TYPE0_TT ||
+            font_attr->type == HPDF_FONT_TYPE0_CID)
+        return InternalWriteEncodedText (attr, font_attr->encoder, text, len);
 
-    return HPDF_Stream_WriteEscapeText (attr->stream, text);
+    return HPDF_Stream_WriteEscapeText2 (attr->stream, text, len);
 }
 
 
@@ -2454,6 +2537,99 @@ HPDF_Page_TextOut  (HPDF_Page    page,
 }
 
 
+/*
+ *  show each run at its absolute position, as HPDF_Page_TextOut does, but
+ *  check the state of the page once and write every run as a relative
+ *  "Td" followed by "Tj". the text of a run need not be null-terminated.
+ */
+HPDF_EXPORT(HPDF_STATUS)
+HPDF_Page_ShowTextRuns  (HPDF_Page             page,
+                         const HPDF_TextRun   *runs,
+                         HPDF_UINT             count)
+{
+    HPDF_STATUS ret = HPDF_Page_CheckState (page, HPDF_GMODE_TEXT_OBJECT);
+    HPDF_PageAttr attr;
+    HPDF_GState gstate;
+    HPDF_UINT i;
+
+    HPDF_PTRACE ((" HPDF_Page_ShowTextRuns\n"));
+
+    if (ret != HPDF_OK)
+        return ret;
+
+    attr = (HPDF_PageAttr)page->attr;
+    gstate = attr->gstate;
+
+    if (count > 0 && !runs)
+        return HPDF_RaiseError (page->error, HPDF_INVALID_PARAMETER, 0);
+
+    /* no font exists */
+    if (count > 0 && !gstate->font)
+        return HPDF_RaiseError (page->error, HPDF_PAGE_FONT_NOT_FOUND, 0);
+
+    for (i = 0; i < count; i++) {
+        const HPDF_TextRun *run = runs + i;
+        char buf[HPDF_TMP_BUF_SIZ];
+        char *pbuf = buf;
+        char *eptr = buf + HPDF_TMP_BUF_SIZ - 1;
+        HPDF_REAL x;
+        HPDF_REAL y;
+        HPDF_REAL tw = 0;
+
+        if (run->len > HPDF_LIMIT_MAX_STRING_LEN)
+            return HPDF_RaiseError (page->error, HPDF_STRING_OUT_OF_RANGE, 0);
+
+        /* Td */
+        TextPos_AbsToRel (attr->text_matrix, run->x, run->y, &x, &y);
+
+        pbuf = HPDF_FToA (pbuf, x, eptr);
+        *pbuf++ = ' ';
+        pbuf = HPDF_FToA (pbuf, y, eptr);
+        pbuf = (char *)HPDF_StrCpy (pbuf, " Td\012", eptr);
+
+        if (HPDF_Stream_Write (attr->stream, (HPDF_BYTE *)buf,
+                    (HPDF_UINT)(pbuf - buf)) != HPDF_OK)
+            return HPDF_CheckError (page->error);
+
+        attr->text_matrix.x += x * attr->text_matrix.a +
+                y * attr->text_matrix.c;
+        attr->text_matrix.y += y * attr->text_matrix.d +
+                x * attr->text_matrix.b;
+        attr->text_pos.x = attr->text_matrix.x;
+        attr->text_pos.y = attr->text_matrix.y;
+
+        /* Tj */
+        if (run->len > 0 && run->text) {
+            HPDF_TextWidth w = HPDF_Font_TextWidth (gstate->font,
+                    (const HPDF_BYTE *)run->text, run->len);
+
+            tw = gstate->word_space * w.numspace +
+                    w.width * gstate->font_size / 1000 +
+                    gstate->char_space * w.numchars;
+        }
+
+        if (!tw)
+            continue;
+
+        if (InternalWriteText2 (attr, run->text, run->len) != HPDF_OK)
+            return HPDF_CheckError (page->error);
+
+        if (HPDF_Stream_WriteStr (attr->stream, " Tj\012") != HPDF_OK)
+            return HPDF_CheckError (page->error);
+
+        if (gstate->writing_mode == HPDF_WMODE_HORIZONTAL) {
+            attr->text_pos.x += tw * attr->text_matrix.a;
+            attr->text_pos.y += tw * attr->text_matrix.b;
+        } else {
+            attr->text_pos.x -= tw * attr->text_matrix.b;
+            attr->text_pos.y -= tw * attr->text_matrix.a;
+        }
+    }
+
+    return ret;
+}
+
+
 HPDF_EXPORT(HPDF_STATUS)
 HPDF_Page_TextRect  (HPDF_Page            page,
                      HPDF_REAL            left,
@@ -2654,28 +2830,8 @@ InternalShowTextNextLine  (HPDF_Page    page,
             font_attr->type == HPDF_FONT_TYPE0_CID) {
         HPDF_Encoder encoder = font_attr->encoder;
 
-        if ((ret = HPDF_Stream_WriteStr (attr->stream, "<")) != HPDF_OK)
-            return ret;
-
-        if (encoder->encode_text_fn == NULL) {
-	    if ((ret = HPDF_Stream_WriteBinary (attr->stream, (HPDF_BYTE *)text,
-						len, NULL))
-		!= HPDF_OK)
-	        return ret;
-        } else {
-	    char *encoded;
-	    HPDF_UINT length;
-
-	    encoded = (encoder->encode_text_fn)(encoder, text, len, &length);
-	    ret = HPDF_Stream_WriteBinary (attr->stream, (HPDF_BYTE *)encoded,
-					   length, NULL);
-	    free(encoded);
-
-	    if (ret != HPDF_OK)
-	        return ret;
-        }
-
-        if ((ret = HPDF_Stream_WriteStr (attr->stream, ">")) != HPDF_OK)
+        if ((ret = InternalWriteEncodedText (attr, encoder, text, len)) !=
+                HPDF_OK)
             return ret;
     } else  if ((ret = HPDF_Stream_WriteEscapeText2 (attr->stream, text,
                 len)) != HPDF_OK)
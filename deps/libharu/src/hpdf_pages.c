@@ -395,6 +395,105 @@ HPDF_Page_CheckState  (HPDF_Page  page,
     if (!(((HPDF_PageAttr)page->attr)->gmode & mode))
         return HPDF_RaiseError (page->error, HPDF_PAGE_INVALID_GMODE, 0);
 
+    /* the content stream has been written out by progressive save */
+    if (!((HPDF_PageAttr)page->attr)->stream)
+        return HPDF_RaiseError (page->error, HPDF_PAGE_ALREADY_FLUSHED, 0);
+
+    return HPDF_OK;
+}
+
+
+static HPDF_STATUS
+FlushContents  (HPDF_Xref    xref,
+                HPDF_Dict    contents,
+                HPDF_Stream  stream)
+{
+    HPDF_Number length;
+    HPDF_STATUS ret;
+
+    /* shared content stream already written with another page */
+    if (!contents->stream)
+        return HPDF_OK;
+
+    if ((ret = HPDF_Xref_FlushObject (xref, contents, stream)) != HPDF_OK)
+        return ret;
+
+    /* "Length" gets its value while the stream is written */
+    length = (HPDF_Number)HPDF_Dict_GetItem (contents, "Length",
+            HPDF_OCLASS_NUMBER);
+    if (!length)
+        return HPDF_SetError (contents->error,
+                HPDF_DICT_STREAM_LENGTH_NOT_FOUND, 0);
+
+    if ((ret = HPDF_Xref_FlushObject (xref, length, stream)) != HPDF_OK)
+        return ret;
+
+    HPDF_Stream_Free (contents->stream);
+    contents->stream = NULL;
+
+    return HPDF_OK;
+}
+
+
+/*
+ *  HPDF_Page_Flush
+ *
+ *  write the content streams of a finished page to the stream and release
+ *  their data. the page dictionary itself stays in memory and is written
+ *  with the rest of the document. the page can not be drawn on afterwards.
+ *
+ */
+HPDF_STATUS
+HPDF_Page_Flush  (HPDF_Page    page,
+                  HPDF_Stream  stream)
+{
+    HPDF_PageAttr attr;
+    HPDF_Array contents_array;
+    HPDF_STATUS ret;
+
+    HPDF_PTRACE((" HPDF_Page_Flush\n"));
+
+    if (!HPDF_Page_Validate (page))
+        return HPDF_INVALID_PAGE;
+
+    attr = (HPDF_PageAttr)page->attr;
+
+    if (!attr->stream)
+        return HPDF_OK;
+
+    /* a form XObject, a path or a text object must not be left open */
+    if (attr->form)
+        return HPDF_RaiseError (page->error, HPDF_INVALID_OPERATION, 0);
+
+    if (attr->gmode != HPDF_GMODE_PAGE_DESCRIPTION)
+        return HPDF_RaiseError (page->error, HPDF_PAGE_INVALID_GMODE, 0);
+
+    contents_array = (HPDF_Array)HPDF_Dict_GetItem (page, "Contents",
+            HPDF_OCLASS_ARRAY);
+    if (contents_array) {
+        HPDF_UINT i;
+
+        for (i = 0; i < contents_array->list->count; i++) {
+            HPDF_Dict contents = (HPDF_Dict)HPDF_Array_GetItem (contents_array,
+                    i, HPDF_OCLASS_DICT);
+
+            if (!contents)
+                return HPDF_Error_GetCode (page->error);
+
+            if ((ret = FlushContents (attr->xref, contents, stream)) !=
+                    HPDF_OK)
+                return ret;
+        }
+    } else {
+        HPDF_Error_Reset (page->error);
+
+        if ((ret = FlushContents (attr->xref, attr->contents, stream)) !=
+                HPDF_OK)
+            return ret;
+    }
+
+    attr->stream = NULL;
+
     return HPDF_OK;
 }
 
@@ -490,35 +589,59 @@ HPDF_Page_GetLocalFontName  (HPDF_Page  page,
                              HPDF_Font  font)
 {
     HPDF_PageAttr attr = (HPDF_PageAttr )page->attr;
+    HPDF_Dict fonts;
     const char *key;
 
     HPDF_PTRACE((" HPDF_Page_GetLocalFontName\n"));
 
-    /* whether check font-resource exists.  when it does not exists,
-     * create font-resource
-     * 2006.07.21 Fixed a problem which may cause a memory leak.
-     */
-    if (!attr->fonts) {
-        HPDF_Dict resources;
-        HPDF_Dict fonts;
-
-        resources = HPDF_Page_GetInheritableItem (page, "Resources",
-                        HPDF_OCLASS_DICT);
+    if (attr->form) {
+        /* while a form is recorded its content is resolved against the
+         * resources of the form, which can be placed on any page; fonts
+         * get names of their own there, independent of the page names.
+         */
+        HPDF_Dict resources = (HPDF_Dict)HPDF_Dict_GetItem (attr->form,
+                "Resources", HPDF_OCLASS_DICT);
         if (!resources)
             return NULL;
 
-        fonts = HPDF_Dict_New (page->mmgr);
-        if (!fonts)
-            return NULL;
+        fonts = (HPDF_Dict)HPDF_Dict_GetItem (resources, "Font",
+                HPDF_OCLASS_DICT);
+        if (!fonts) {
+            fonts = HPDF_Dict_New (page->mmgr);
+            if (!fonts)
+                return NULL;
 
-        if (HPDF_Dict_Add (resources, "Font", fonts) != HPDF_OK)
-            return NULL;
+            if (HPDF_Dict_Add (resources, "Font", fonts) != HPDF_OK)
+                return NULL;
+        }
+    } else {
+        /* whether check font-resource exists.  when it does not exists,
+         * create font-resource
+         * 2006.07.21 Fixed a problem which may cause a memory leak.
+         */
+        if (!attr->fonts) {
+            HPDF_Dict resources;
 
-        attr->fonts = fonts;
+            resources = HPDF_Page_GetInheritableItem (page, "Resources",
+                            HPDF_OCLASS_DICT);
+            if (!resources)
+                return NULL;
+
+            fonts = HPDF_Dict_New (page->mmgr);
+            if (!fonts)
+                return NULL;
+
+            if (HPDF_Dict_Add (resources, "Font", fonts) != HPDF_OK)
+                return NULL;
+
+            attr->fonts = fonts;
+        }
+
+        fonts = attr->fonts;
     }
 
     /* search font-object from font-resource */
-    key = HPDF_Dict_GetKeyByObj (attr->fonts, font);
+    key = HPDF_Dict_GetKeyByObj (fonts, font);
     if (!key) {
         /* if the font is not registered in font-resource, register font to
          * font-resource.
@@ -528,12 +651,12 @@ HPDF_Page_GetLocalFontName  (HPDF_Page  page,
         char *end_ptr = fontName + HPDF_LIMIT_MAX_NAME_LEN;
 
         ptr = (char *)HPDF_StrCpy (fontName, "F", end_ptr);
-        HPDF_IToA (ptr, attr->fonts->list->count + 1, end_ptr);
+        HPDF_IToA (ptr, fonts->list->count + 1, end_ptr);
 
-        if (HPDF_Dict_Add (attr->fonts, fontName, font) != HPDF_OK)
+        if (HPDF_Dict_Add (fonts, fontName, font) != HPDF_OK)
             return NULL;
 
-        key = HPDF_Dict_GetKeyByObj (attr->fonts, font);
+        key = HPDF_Dict_GetKeyByObj (fonts, font);
     }
 
     return key;
@@ -822,6 +945,174 @@ HPDF_Page_CreateXObjectAsWhiteRect  (HPDF_Doc   pdf,
     return fromxobject;
 }
 
+static HPDF_STATUS
+StartFormRecording  (HPDF_Page  page,
+                     HPDF_Dict  form)
+{
+    HPDF_PageAttr attr = (HPDF_PageAttr)page->attr;
+    HPDF_GState new_gstate = HPDF_GState_New (page->mmgr, attr->gstate);
+
+    if (!new_gstate)
+        return HPDF_CheckError (page->error);
+
+    /* the font selected on the page is named in the page resources and
+     * may differ on the pages the form is placed on (or resumed from), so
+     * the text of the form has to select its font inside the form */
+    new_gstate->font = NULL;
+    new_gstate->font_size = 0;
+
+    attr->gstate = new_gstate;
+    attr->form = form;
+    attr->stream = form->stream;
+
+    return HPDF_OK;
+}
+
+
+/*
+ *  HPDF_Page_BeginFormXObject
+ *
+ *  start recording a form XObject. until HPDF_Page_EndFormXObject the
+ *  page operators write into the stream of the form instead of the page
+ *  contents, so a fragment drawn once can be placed again with
+ *  HPDF_Page_ExecuteXObject. the graphics state is saved without writing
+ *  "q" to the page and restored by HPDF_Page_EndFormXObject. the recording
+ *  starts without a current font: fonts selected while recording are
+ *  registered in the resources of the form only.
+ *
+ */
+HPDF_EXPORT(HPDF_XObject)
+HPDF_Page_BeginFormXObject  (HPDF_Page  page,
+                             HPDF_Rect  bbox)
+{
+    HPDF_PageAttr attr;
+    HPDF_Dict form;
+    HPDF_Dict resources;
+    HPDF_Array array;
+    HPDF_STATUS ret = HPDF_Page_CheckState (page,
+                HPDF_GMODE_PAGE_DESCRIPTION);
+
+    HPDF_PTRACE((" HPDF_Page_BeginFormXObject\n"));
+
+    if (ret != HPDF_OK)
+        return NULL;
+
+    attr = (HPDF_PageAttr)page->attr;
+
+    if (attr->form) {
+        HPDF_RaiseError (page->error, HPDF_INVALID_OPERATION, 0);
+        return NULL;
+    }
+
+    form = HPDF_DictStream_New (page->mmgr, attr->xref);
+    if (!form) {
+        HPDF_CheckError (page->error);
+        return NULL;
+    }
+
+    form->header.obj_class |= HPDF_OSUBCLASS_XOBJECT;
+
+    /* the form is compressed the same way as the page contents */
+    form->filter = attr->contents->filter;
+
+    ret += HPDF_Dict_AddName (form, "Type", "XObject");
+    ret += HPDF_Dict_AddName (form, "Subtype", "Form");
+
+    array = HPDF_Array_New (page->mmgr);
+    if (!array) {
+        HPDF_CheckError (page->error);
+        return NULL;
+    }
+
+    ret += HPDF_Dict_Add (form, "BBox", array);
+    ret += HPDF_Array_AddReal (array, bbox.left);
+    ret += HPDF_Array_AddReal (array, bbox.bottom);
+    ret += HPDF_Array_AddReal (array, bbox.right);
+    ret += HPDF_Array_AddReal (array, bbox.top);
+
+    resources = HPDF_Dict_New (page->mmgr);
+    if (!resources) {
+        HPDF_CheckError (page->error);
+        return NULL;
+    }
+
+    ret += HPDF_Dict_Add (form, "Resources", resources);
+
+    if (ret != HPDF_OK) {
+        HPDF_CheckError (page->error);
+        return NULL;
+    }
+
+    if (StartFormRecording (page, form) != HPDF_OK)
+        return NULL;
+
+    return form;
+}
+
+
+/*
+ *  HPDF_Page_ResumeFormXObject
+ *
+ *  continue recording a form XObject created with HPDF_Page_BeginFormXObject
+ *  (on this or another page of the document). the new operators are appended
+ *  to the content of the form. a form can be placed on pages before its
+ *  content is complete, e.g. to show a value known only when the document
+ *  is saved. font names are resolved against the resources of the form, not
+ *  of the resuming page, and the font has to be selected again before text
+ *  is shown.
+ *
+ */
+HPDF_EXPORT(HPDF_STATUS)
+HPDF_Page_ResumeFormXObject  (HPDF_Page     page,
+                              HPDF_XObject  form)
+{
+    HPDF_PageAttr attr;
+    HPDF_STATUS ret = HPDF_Page_CheckState (page,
+                HPDF_GMODE_PAGE_DESCRIPTION);
+
+    HPDF_PTRACE((" HPDF_Page_ResumeFormXObject\n"));
+
+    if (ret != HPDF_OK)
+        return ret;
+
+    attr = (HPDF_PageAttr)page->attr;
+
+    if (attr->form)
+        return HPDF_RaiseError (page->error, HPDF_INVALID_OPERATION, 0);
+
+    if (!form || form->header.obj_class !=
+                (HPDF_OSUBCLASS_XOBJECT | HPDF_OCLASS_DICT) || !form->stream)
+        return HPDF_RaiseError (page->error, HPDF_INVALID_OBJECT, 0);
+
+    return StartFormRecording (page, form);
+}
+
+
+HPDF_EXPORT(HPDF_STATUS)
+HPDF_Page_EndFormXObject  (HPDF_Page  page)
+{
+    HPDF_PageAttr attr;
+    HPDF_STATUS ret = HPDF_Page_CheckState (page,
+                HPDF_GMODE_PAGE_DESCRIPTION);
+
+    HPDF_PTRACE((" HPDF_Page_EndFormXObject\n"));
+
+    if (ret != HPDF_OK)
+        return ret;
+
+    attr = (HPDF_PageAttr)page->attr;
+
+    if (!attr->form)
+        return HPDF_RaiseError (page->error, HPDF_INVALID_OPERATION, 0);
+
+    attr->gstate = HPDF_GState_Free (page->mmgr, attr->gstate);
+    attr->form = NULL;
+    attr->stream = attr->contents->stream;
+
+    return HPDF_OK;
+}
+
+
 const char*
 HPDF_Page_GetXObjectName  (HPDF_Page     page,
                            HPDF_XObject  xobj)
@@ -31,10 +31,16 @@
 #include "hpdf_streams.h"
 
 #ifdef LIBHPDF_HAVE_ZLIB
-#include <zlib.h>
-#include <zconf.h>
+#include <stdlib.h>
 #endif /* LIBHPDF_HAVE_ZLIB */
 
+#ifdef LIBHPDF_HAVE_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif /* LIBHPDF_HAVE_MMAP */
+
 HPDF_STATUS
 HPDF_MemStream_WriteFunc  (HPDF_Stream      stream,
                            const HPDF_BYTE  *ptr,
@@ -72,6 +78,7 @@ HPDF_MemStream_InWrite  (HPDF_Stream      stream,
 HPDF_STATUS
 HPDF_Stream_WriteToStreamWithDeflate  (HPDF_Stream  src,
                                        HPDF_Stream  dst,
+                                       HPDF_UINT    filter,
                                        HPDF_Encrypt  e);
 
 
@@ -488,6 +495,18 @@ HPDF_Stream_WriteEscapeText  (HPDF_Stream    stream,
     return HPDF_Stream_WriteEscapeText2(stream, text, len);
 }
 
+/* two hex digits of each byte value, looked up instead of computed */
+static const char HEX_DIGIT_PAIRS[] =
+    "000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F"
+    "202122232425262728292A2B2C2D2E2F303132333435363738393A3B3C3D3E3F"
+    "404142434445464748494A4B4C4D4E4F505152535455565758595A5B5C5D5E5F"
+    "606162636465666768696A6B6C6D6E6F707172737475767778797A7B7C7D7E7F"
+    "808182838485868788898A8B8C8D8E8F909192939495969798999A9B9C9D9E9F"
+    "A0A1A2A3A4A5A6A7A8A9AAABACADAEAFB0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+    "C0C1C2C3C4C5C6C7C8C9CACBCCCDCECFD0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+    "E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEFF0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+
+
 HPDF_STATUS
 HPDF_Stream_WriteBinary  (HPDF_Stream      stream,
                           const HPDF_BYTE  *data,
@@ -520,20 +539,10 @@ HPDF_Stream_WriteBinary  (HPDF_Stream      stream,
     }
 
     for (i = 0; i < len; i++, p++) {
-        char c = (char)(*p >> 4);
+        const char *pair = HEX_DIGIT_PAIRS + (*p << 1);
 
-        if (c <= 9)
-            c += 0x30;
-        else
-            c += 0x41 - 10;
-        buf[idx++] = c;
-
-        c = (char)(*p & 0x0f);
-        if (c <= 9)
-            c += 0x30;
-        else
-            c += 0x41 - 10;
-        buf[idx++] = c;
+        buf[idx++] = pair[0];
+        buf[idx++] = pair[1];
 
         if (idx > HPDF_TEXT_DEFAULT_LEN - 2) {
             ret = HPDF_Stream_Write (stream, (HPDF_BYTE *)buf, idx);
@@ -560,124 +569,63 @@ HPDF_Stream_WriteBinary  (HPDF_Stream      stream,
 HPDF_STATUS
 HPDF_Stream_WriteToStreamWithDeflate  (HPDF_Stream  src,
                                        HPDF_Stream  dst,
+                                       HPDF_UINT    filter,
                                        HPDF_Encrypt  e)
 {
 #ifdef LIBHPDF_HAVE_ZLIB
-
-#define DEFLATE_BUF_SIZ  ((HPDF_INT)(HPDF_STREAM_BUF_SIZ * 1.1) + 13)
-
+    HPDF_Error error = src->error;
+    HPDF_Stream tmp = NULL;
     HPDF_STATUS ret;
-    HPDF_BOOL flg;
-
-    z_stream strm;
-    Bytef inbuf[HPDF_STREAM_BUF_SIZ];
-    Bytef otbuf[DEFLATE_BUF_SIZ];
-    HPDF_BYTE ebuf[DEFLATE_BUF_SIZ];
+    HPDF_BYTE *buf;
+    HPDF_UINT size;
+    HPDF_INT detail;
 
     HPDF_PTRACE((" HPDF_Stream_WriteToStreamWithDeflate\n"));
 
-    /* initialize input stream */
-    ret = HPDF_Stream_Seek (src, 0, HPDF_SEEK_SET);
-    if (ret != HPDF_OK)
-        return ret;
-
-    /* initialize decompression stream. */
-    HPDF_MemSet(&strm, 0x00, sizeof(z_stream));
-    strm.next_out = otbuf;
-    strm.avail_out = DEFLATE_BUF_SIZ;
-
-    ret = deflateInit_(&strm, Z_DEFAULT_COMPRESSION, ZLIB_VERSION,
-            sizeof(z_stream));
-    if (ret != Z_OK)
-        return HPDF_SetError (src->error, HPDF_ZLIB_ERROR, ret);
-
-    strm.next_in = inbuf;
-    strm.avail_in = 0;
-
-    flg = HPDF_FALSE;
-    for (;;) {
-        HPDF_UINT size = HPDF_STREAM_BUF_SIZ;
-
-        ret = HPDF_Stream_Read (src, inbuf, &size);
-
-        strm.next_in = inbuf;
-        strm.avail_in = size;
+    /* the data is deflated at once, other streams are collected in memory */
+    if (src->type != HPDF_STREAM_MEMORY) {
+        tmp = HPDF_MemStream_New (src->mmgr, HPDF_DEFLATE_BUF_SIZ);
+        if (!tmp)
+            return HPDF_Error_GetCode (error);
 
+        ret = HPDF_Stream_WriteToStream (src, tmp, HPDF_STREAM_FILTER_NONE,
+                NULL);
         if (ret != HPDF_OK) {
-            if (ret == HPDF_STREAM_EOF) {
-                flg = HPDF_TRUE;
-                if (size == 0)
-                    break;
-            } else {
-                deflateEnd(&strm);
-                return ret;
-            }
-        }
-
-        while (strm.avail_in > 0) {
-            ret = deflate(&strm, Z_NO_FLUSH);
-            if (ret != Z_OK && ret != Z_STREAM_END) {
-                deflateEnd(&strm);
-                return HPDF_SetError (src->error, HPDF_ZLIB_ERROR, ret);
-            }
-
-            if (strm.avail_out == 0) {
-                if (e) {
-                    HPDF_Encrypt_CryptBuf (e, otbuf, ebuf, DEFLATE_BUF_SIZ);
-                    ret = HPDF_Stream_Write(dst, ebuf, DEFLATE_BUF_SIZ);
-                } else
-                    ret = HPDF_Stream_Write (dst, otbuf, DEFLATE_BUF_SIZ);
-
-                if (ret != HPDF_OK) {
-                    deflateEnd(&strm);
-                    return HPDF_SetError (src->error, HPDF_ZLIB_ERROR, ret);
-                }
-
-                strm.next_out = otbuf;
-                strm.avail_out = DEFLATE_BUF_SIZ;
-            }
+            HPDF_Stream_Free (tmp);
+            return ret;
         }
-
-        if (flg)
-            break;
+        src = tmp;
     }
 
-    flg = HPDF_FALSE;
-    for (;;) {
-        ret = deflate(&strm, Z_FINISH);
-        if (ret != Z_OK && ret != Z_STREAM_END) {
-            deflateEnd(&strm);
-            return HPDF_SetError (src->error, HPDF_ZLIB_ERROR, ret);
-        }
+    ret = HPDF_MemStream_Deflate (src, filter, &buf, &size, &detail);
 
-        if (ret == Z_STREAM_END)
-            flg = HPDF_TRUE;
+    if (tmp)
+        HPDF_Stream_Free (tmp);
 
-        if (strm.avail_out < DEFLATE_BUF_SIZ) {
-            HPDF_UINT osize = DEFLATE_BUF_SIZ - strm.avail_out;
-            if (e) {
-                HPDF_Encrypt_CryptBuf (e, otbuf, ebuf, osize);
-                ret = HPDF_Stream_Write(dst, ebuf, osize);
-            } else
-                ret = HPDF_Stream_Write (dst, otbuf, osize);
+    if (ret != HPDF_OK)
+        return HPDF_SetError (error, ret, detail);
 
-            if (ret != HPDF_OK) {
-                deflateEnd(&strm);
-                return HPDF_SetError (src->error, HPDF_ZLIB_ERROR, ret);
-            }
+    if (e) {
+        HPDF_BYTE ebuf[HPDF_STREAM_BUF_SIZ];
+        HPDF_UINT pos;
+
+        for (pos = 0; pos < size && ret == HPDF_OK;
+                pos += HPDF_STREAM_BUF_SIZ) {
+            HPDF_UINT len = (size - pos < HPDF_STREAM_BUF_SIZ) ? size - pos :
+                    HPDF_STREAM_BUF_SIZ;
 
-            strm.next_out = otbuf;
-            strm.avail_out = DEFLATE_BUF_SIZ;
+            HPDF_Encrypt_CryptBuf (e, buf + pos, ebuf, len);
+            ret = HPDF_Stream_Write (dst, ebuf, len);
         }
+    } else
+        ret = HPDF_Stream_Write (dst, buf, size);
 
-        if (flg)
-            break;
-    }
+    free (buf);
 
-    deflateEnd(&strm);
-    return HPDF_OK;
+    return ret;
 #else /* LIBHPDF_HAVE_ZLIB */
     HPDF_UNUSED (e);
+    HPDF_UNUSED (filter);
     HPDF_UNUSED (dst);
     HPDF_UNUSED (src);
     return HPDF_UNSUPPORTED_FUNC;
@@ -713,7 +661,7 @@ HPDF_Stream_WriteToStream  (HPDF_Stream  src,
 
 #ifdef LIBHPDF_HAVE_ZLIB
     if (filter & HPDF_STREAM_FILTER_FLATE_DECODE)
-        return HPDF_Stream_WriteToStreamWithDeflate (src, dst, e);
+        return HPDF_Stream_WriteToStreamWithDeflate (src, dst, filter, e);
 #endif /* LIBHPDF_HAVE_ZLIB */
 
     ret = HPDF_Stream_Seek (src, 0, HPDF_SEEK_SET);
@@ -1456,6 +1404,258 @@ HPDF_CallbackWriter_New (HPDF_MMgr               mmgr,
 
 
 
+/*
+ *  HPDF_BufferReader_New
+ *
+ *  Constructor for a read-only stream over a block of memory.
+ *  The block is owned by the caller: it is neither copied nor freed by the
+ *  stream and must stay valid until the stream is freed. Any number of
+ *  readers may share one block, each of them has its own position.
+ *
+ *  mmgr : Pointer to a HPDF_MMgr object.
+ *  buf : Pointer to the data.
+ *  size : Size of the data.
+ *
+ *  return: If success, It returns pointer to new HPDF_Stream object,
+ *          otherwise, it returns NULL.
+ *
+ */
+
+static HPDF_STATUS
+BufferReader_ReadFunc  (HPDF_Stream  stream,
+                        HPDF_BYTE    *ptr,
+                        HPDF_UINT    *siz)
+{
+    HPDF_BufferReaderAttr attr = (HPDF_BufferReaderAttr)stream->attr;
+    HPDF_UINT rest = attr->size - attr->pos;
+
+    HPDF_PTRACE((" BufferReader_ReadFunc\n"));
+
+    if (*siz > rest) {
+        HPDF_MemCpy (ptr, attr->buf + attr->pos, rest);
+        HPDF_MemSet (ptr + rest, 0, *siz - rest);
+        attr->pos = attr->size;
+        *siz = rest;
+
+        return HPDF_STREAM_EOF;
+    }
+
+    HPDF_MemCpy (ptr, attr->buf + attr->pos, *siz);
+    attr->pos += *siz;
+
+    return HPDF_OK;
+}
+
+
+static HPDF_STATUS
+BufferReader_SeekFunc  (HPDF_Stream      stream,
+                        HPDF_INT         pos,
+                        HPDF_WhenceMode  mode)
+{
+    HPDF_BufferReaderAttr attr = (HPDF_BufferReaderAttr)stream->attr;
+    HPDF_INT new_pos;
+
+    HPDF_PTRACE((" BufferReader_SeekFunc\n"));
+
+    switch (mode) {
+        case HPDF_SEEK_CUR:
+            new_pos = (HPDF_INT)attr->pos + pos;
+            break;
+        case HPDF_SEEK_END:
+            new_pos = (HPDF_INT)attr->size + pos;
+            break;
+        default:
+            new_pos = pos;
+    }
+
+    if (new_pos < 0 || (HPDF_UINT)new_pos > attr->size)
+        return HPDF_SetError (stream->error, HPDF_STREAM_EOF, 0);
+
+    attr->pos = (HPDF_UINT)new_pos;
+
+    return HPDF_OK;
+}
+
+
+static HPDF_INT32
+BufferReader_TellFunc  (HPDF_Stream  stream)
+{
+    HPDF_BufferReaderAttr attr = (HPDF_BufferReaderAttr)stream->attr;
+
+    return (HPDF_INT32)attr->pos;
+}
+
+
+static HPDF_UINT32
+BufferReader_SizeFunc  (HPDF_Stream  stream)
+{
+    HPDF_BufferReaderAttr attr = (HPDF_BufferReaderAttr)stream->attr;
+
+    return attr->size;
+}
+
+
+static void
+BufferReader_FreeFunc  (HPDF_Stream  stream)
+{
+    HPDF_BufferReaderAttr attr = (HPDF_BufferReaderAttr)stream->attr;
+
+    HPDF_PTRACE((" BufferReader_FreeFunc\n"));
+
+#ifdef LIBHPDF_HAVE_MMAP
+    if (attr->mapped)
+        munmap ((void *)attr->buf, attr->size);
+#endif /* LIBHPDF_HAVE_MMAP */
+
+    HPDF_FreeMem (stream->mmgr, attr);
+    stream->attr = NULL;
+}
+
+
+HPDF_Stream
+HPDF_BufferReader_New  (HPDF_MMgr         mmgr,
+                        const HPDF_BYTE  *buf,
+                        HPDF_UINT         size)
+{
+    HPDF_Stream stream;
+    HPDF_BufferReaderAttr attr;
+
+    HPDF_PTRACE((" HPDF_BufferReader_New\n"));
+
+    stream = (HPDF_Stream)HPDF_GetMem (mmgr, sizeof(HPDF_Stream_Rec));
+    if (!stream)
+        return NULL;
+
+    attr = (HPDF_BufferReaderAttr)HPDF_GetMem (mmgr,
+            sizeof(HPDF_BufferReaderAttr_Rec));
+    if (!attr) {
+        HPDF_FreeMem (mmgr, stream);
+        return NULL;
+    }
+
+    attr->buf = buf;
+    attr->size = size;
+    attr->pos = 0;
+    attr->mapped = HPDF_FALSE;
+
+    HPDF_MemSet (stream, 0, sizeof(HPDF_Stream_Rec));
+    stream->sig_bytes = HPDF_STREAM_SIG_BYTES;
+    stream->type = HPDF_STREAM_BUFFER;
+    stream->error = mmgr->error;
+    stream->mmgr = mmgr;
+    stream->read_fn = BufferReader_ReadFunc;
+    stream->seek_fn = BufferReader_SeekFunc;
+    stream->tell_fn = BufferReader_TellFunc;
+    stream->size_fn = BufferReader_SizeFunc;
+    stream->free_fn = BufferReader_FreeFunc;
+    stream->attr = attr;
+
+    return stream;
+}
+
+
+/*
+ *  HPDF_BufferReader_Read
+ *
+ *  Read size bytes of a buffer reader in place: it returns a pointer to the
+ *  data at the current position and moves the position past it. If less
+ *  than size bytes remain, it returns NULL and the position is unchanged.
+ *
+ */
+
+const HPDF_BYTE*
+HPDF_BufferReader_Read  (HPDF_Stream  stream,
+                         HPDF_UINT    size)
+{
+    HPDF_BufferReaderAttr attr = (HPDF_BufferReaderAttr)stream->attr;
+    const HPDF_BYTE *p;
+
+    if (size > attr->size - attr->pos)
+        return NULL;
+
+    p = attr->buf + attr->pos;
+    attr->pos += size;
+
+    return p;
+}
+
+
+const HPDF_BYTE*
+HPDF_BufferReader_GetBuf  (HPDF_Stream  stream,
+                           HPDF_UINT   *size)
+{
+    HPDF_BufferReaderAttr attr = (HPDF_BufferReaderAttr)stream->attr;
+
+    *size = attr->size;
+
+    return attr->buf;
+}
+
+
+/*
+ *  HPDF_MappedFileReader_New
+ *
+ *  Constructor for a read-only stream over a file which is mapped into
+ *  memory, so reading is copying from the mapping (or reading it in place
+ *  with HPDF_BufferReader_Read) and the pages of the file are shared with
+ *  other processes through the page cache. The file must not be truncated
+ *  while the stream exists.
+ *  Where mmap is not available, or the file cannot be mapped, it returns an
+ *  ordinary HPDF_FileReader.
+ *
+ *  mmgr : Pointer to a HPDF_MMgr object.
+ *  fname : File name to open.
+ *
+ *  return: If success, It returns pointer to new HPDF_Stream object,
+ *          otherwise, it returns NULL.
+ *
+ */
+
+HPDF_Stream
+HPDF_MappedFileReader_New  (HPDF_MMgr    mmgr,
+                            const char  *fname)
+{
+#ifdef LIBHPDF_HAVE_MMAP
+    HPDF_Stream stream;
+    struct stat st;
+    void *buf;
+    int fd;
+
+    HPDF_PTRACE((" HPDF_MappedFileReader_New\n"));
+
+    fd = open (fname, O_RDONLY);
+    if (fd < 0)
+        return HPDF_FileReader_New (mmgr, fname);
+
+    /* positions of a stream are HPDF_INT */
+    if (fstat (fd, &st) != 0 || st.st_size <= 0 ||
+            st.st_size > HPDF_LIMIT_MAX_INT) {
+        close (fd);
+        return HPDF_FileReader_New (mmgr, fname);
+    }
+
+    buf = mmap (NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close (fd);
+
+    if (buf == MAP_FAILED)
+        return HPDF_FileReader_New (mmgr, fname);
+
+    stream = HPDF_BufferReader_New (mmgr, (const HPDF_BYTE *)buf,
+            (HPDF_UINT)st.st_size);
+    if (!stream) {
+        munmap (buf, (size_t)st.st_size);
+        return NULL;
+    }
+
+    ((HPDF_BufferReaderAttr)stream->attr)->mapped = HPDF_TRUE;
+
+    return stream;
+#else
+    return HPDF_FileReader_New (mmgr, fname);
+#endif /* LIBHPDF_HAVE_MMAP */
+}
+
+
 HPDF_STATUS
 HPDF_Stream_Validate  (HPDF_Stream  stream)
 {
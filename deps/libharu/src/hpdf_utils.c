@@ -178,10 +178,11 @@ HPDF_IToA2  (char         *s,
 }
 
 
-char*
-HPDF_FToA  (char       *s,
-            HPDF_REAL   val,
-            char       *eptr)
+/* general case: values out of the range of the fast path of HPDF_FToA */
+static char*
+FToAGeneric  (char       *s,
+              HPDF_REAL   val,
+              char       *eptr)
 {
     HPDF_REAL int_val;
     HPDF_REAL fpart_val;
@@ -192,20 +193,9 @@ HPDF_FToA  (char       *s,
     HPDF_INT32 logVal;
     HPDF_UINT32 prec;
 
-    if (val > HPDF_LIMIT_MAX_REAL)
-        val = HPDF_LIMIT_MAX_REAL;
-    else
-    if (val < HPDF_LIMIT_MIN_REAL)
-        val = HPDF_LIMIT_MIN_REAL;
-
     t = buf;
     *t++ = 0;
 
-    if (val < 0) {
-        *s++ = '-';
-        val = -val;
-    }
-
     /* compute the decimal precision to write at least 5 significant figures */
     logVal = (HPDF_INT32)(val > 1e-20 ? log10(val) : 0.);
     if (logVal >= 0) {
@@ -256,6 +246,111 @@ HPDF_FToA  (char       *s,
 }
 
 
+
+/*
+ *  HPDF_FToA
+ *
+ *  write the value with the decimal precision giving at least 5
+ *  significant figures (5 digits after the point for val >= 0.1), the
+ *  digits past the precision are truncated and trailing zeros dropped.
+ *  values in the range of page coordinates are formatted with integer
+ *  arithmetic: a float has 24 significant bits, so val * 10^prec is exact
+ *  in double while prec <= 12 and the scaled value fits in 53 bits.
+ */
+
+#define HPDF_FTOA_MAX_FAST     1e9
+#define HPDF_FTOA_MAX_PREC     12
+
+char*
+HPDF_FToA  (char       *s,
+            HPDF_REAL   val,
+            char       *eptr)
+{
+    static const HPDF_UINT64 pow10[HPDF_FTOA_MAX_PREC + 1] = {
+        1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+        10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+        100000000000ULL, 1000000000000ULL
+    };
+    static const double neg_pow10[HPDF_FTOA_MAX_PREC - 5 + 2] = {
+        1e-0, 1e-1, 1e-2, 1e-3, 1e-4, 1e-5, 1e-6, 1e-7, 1e-8
+    };
+    char buf[HPDF_REAL_LEN + 1];
+    char* t = buf + HPDF_REAL_LEN;
+    double dval;
+    HPDF_UINT64 scaled;
+    HPDF_UINT32 int_part;
+    HPDF_UINT32 prec;
+    HPDF_UINT32 k;
+
+    if (val > HPDF_LIMIT_MAX_REAL)
+        val = HPDF_LIMIT_MAX_REAL;
+    else
+    if (val < HPDF_LIMIT_MIN_REAL)
+        val = HPDF_LIMIT_MIN_REAL;
+
+    if (val < 0) {
+        *s++ = '-';
+        val = -val;
+    }
+
+    dval = val;
+    if (dval >= HPDF_FTOA_MAX_FAST)
+        return FToAGeneric (s, val, eptr);
+
+    *t = 0;
+    int_part = (HPDF_UINT32)dval;
+
+    /* fractional part: prec digits, without the trailing zeros */
+    if (dval != (double)int_part) {
+        HPDF_UINT64 frac;
+
+        /* the same precision as (HPDF_INT32)log10(val) gives */
+        for (k = 0; k < HPDF_FTOA_MAX_PREC - 5 + 1 && dval <= neg_pow10[k + 1];
+                k++)
+            ;
+        if (k > HPDF_FTOA_MAX_PREC - 5)
+            return FToAGeneric (s, val, eptr);
+        prec = 5 + k;
+
+        scaled = (HPDF_UINT64)(dval * (double)pow10[prec]);
+        frac = scaled - (HPDF_UINT64)int_part * pow10[prec];
+
+        if (frac != 0) {
+            /* drop the trailing zeros, then write the remaining digits */
+            for (k = 0; frac % 10 == 0; k++)
+                frac /= 10;
+
+            if (frac <= 0xFFFFFFFFULL) {
+                HPDF_UINT32 frac32 = (HPDF_UINT32)frac;
+
+                for (; k < prec; k++) {
+                    *--t = (char)(frac32 % 10 + '0');
+                    frac32 /= 10;
+                }
+            } else {
+                for (; k < prec; k++) {
+                    *--t = (char)(frac % 10 + '0');
+                    frac /= 10;
+                }
+            }
+            *--t = '.';
+        }
+    }
+
+    /* integer part */
+    do {
+        *--t = (char)(int_part % 10 + '0');
+        int_part /= 10;
+    } while (int_part > 0);
+
+    while (s < eptr && *t != 0)
+        *s++ = *t++;
+    *s = 0;
+
+    return s;
+}
+
+
 HPDF_BYTE*
 HPDF_MemCpy  (HPDF_BYTE*         out,
               const HPDF_BYTE   *in,
@@ -24,6 +24,17 @@ WriteTrailer  (HPDF_Xref     xref,
                HPDF_Stream   stream);
 
 
+static HPDF_XrefEntry
+NewEntry  (HPDF_Xref  xref);
+
+
+static HPDF_STATUS
+WriteObject  (HPDF_XrefEntry  entry,
+              HPDF_UINT       obj_id,
+              HPDF_Stream     stream,
+              HPDF_Encrypt    e);
+
+
 HPDF_Xref
 HPDF_Xref_New  (HPDF_MMgr     mmgr,
                 HPDF_UINT32   offset)
@@ -42,23 +53,17 @@ HPDF_Xref_New  (HPDF_MMgr     mmgr,
     xref->error = mmgr->error;
     xref->start_offset = offset;
 
-    xref->entries = HPDF_List_New (mmgr, HPDF_DEFALUT_XREF_ENTRY_NUM);
-    if (!xref->entries)
+    xref->entry_blocks = HPDF_List_New (mmgr, HPDF_DEF_ITEMS_PER_BLOCK);
+    if (!xref->entry_blocks)
         goto Fail;
 
     xref->addr = 0;
 
     if (xref->start_offset == 0) {
-        new_entry = (HPDF_XrefEntry)HPDF_GetMem (mmgr,
-                sizeof(HPDF_XrefEntry_Rec));
+        new_entry = NewEntry (xref);
         if (!new_entry)
             goto Fail;
 
-        if (HPDF_List_Add (xref->entries, new_entry) != HPDF_OK) {
-            HPDF_FreeMem (mmgr, new_entry);
-            goto Fail;
-        }
-
         /* add first entry which is free entry and whose generation
          * number is 0
          */
@@ -66,6 +71,7 @@ HPDF_Xref_New  (HPDF_MMgr     mmgr,
         new_entry->byte_offset = 0;
         new_entry->gen_no = HPDF_MAX_GENERATION_NUM;
         new_entry->obj = NULL;
+        new_entry->flushed = HPDF_FALSE;
     }
 
     xref->trailer = HPDF_Dict_New (mmgr);
@@ -96,15 +102,18 @@ HPDF_Xref_Free  (HPDF_Xref  xref)
     while (xref) {
         /* delete all objects belong to the xref. */
 
-        if (xref->entries) {
-            for (i = 0; i < xref->entries->count; i++) {
+        if (xref->entry_blocks) {
+            for (i = 0; i < xref->count; i++) {
                 entry = HPDF_Xref_GetEntry (xref, i);
                 if (entry->obj)
                     HPDF_Obj_ForceFree (xref->mmgr, entry->obj);
-                HPDF_FreeMem (xref->mmgr, entry);
             }
 
-            HPDF_List_Free(xref->entries);
+            for (i = 0; i < xref->entry_blocks->count; i++)
+                HPDF_FreeMem (xref->mmgr,
+                        HPDF_List_ItemAt (xref->entry_blocks, i));
+
+            HPDF_List_Free(xref->entry_blocks);
         }
 
         if (xref->trailer)
@@ -139,7 +148,7 @@ HPDF_Xref_Add  (HPDF_Xref  xref,
             header->obj_id & HPDF_OTYPE_INDIRECT)
         return HPDF_SetError(xref->error, HPDF_INVALID_OBJECT, 0);
 
-    if (xref->entries->count >= HPDF_LIMIT_MAX_XREF_ELEMENT) {
+    if (xref->count >= HPDF_LIMIT_MAX_XREF_ELEMENT) {
         HPDF_SetError(xref->error, HPDF_XREF_COUNT_ERR, 0);
         goto Fail;
     }
@@ -148,21 +157,16 @@ HPDF_Xref_Add  (HPDF_Xref  xref,
      * occurred.
      */
 
-    entry = (HPDF_XrefEntry)HPDF_GetMem (xref->mmgr,
-            sizeof(HPDF_XrefEntry_Rec));
+    entry = NewEntry (xref);
     if (entry == NULL)
         goto Fail;
 
-    if (HPDF_List_Add(xref->entries, entry) != HPDF_OK) {
-        HPDF_FreeMem (xref->mmgr, entry);
-        goto Fail;
-    }
-
     entry->entry_typ = HPDF_IN_USE_ENTRY;
     entry->byte_offset = 0;
     entry->gen_no = 0;
     entry->obj = obj;
-    header->obj_id = xref->start_offset + xref->entries->count - 1 +
+    entry->flushed = HPDF_FALSE;
+    header->obj_id = xref->start_offset + xref->count - 1 +
                     HPDF_OTYPE_INDIRECT;
 
     header->gen_no = entry->gen_no;
@@ -174,13 +178,69 @@ Fail:
     return HPDF_Error_GetCode (xref->error);
 }
 
+/*
+ *  entries live in fixed-size blocks which are never moved, so an entry
+ *  keeps its address and neighbouring entries are adjacent in memory.
+ */
+static HPDF_XrefEntry
+NewEntry  (HPDF_Xref  xref)
+{
+    HPDF_UINT pos = xref->count % HPDF_XREF_ENTRIES_PER_BLOCK;
+    HPDF_XrefEntry block;
+
+    if (pos == 0) {
+        block = (HPDF_XrefEntry)HPDF_GetMem (xref->mmgr,
+                sizeof(HPDF_XrefEntry_Rec) * HPDF_XREF_ENTRIES_PER_BLOCK);
+        if (!block)
+            return NULL;
+
+        if (HPDF_List_Add (xref->entry_blocks, block) != HPDF_OK) {
+            HPDF_FreeMem (xref->mmgr, block);
+            return NULL;
+        }
+    } else {
+        block = (HPDF_XrefEntry)HPDF_List_ItemAt (xref->entry_blocks,
+                xref->entry_blocks->count - 1);
+    }
+
+    xref->count++;
+
+    return block + pos;
+}
+
+
+/*
+ *  entries themselves are never moved, so reserving only sizes the list of
+ *  entry blocks for count more objects.
+ */
+HPDF_STATUS
+HPDF_Xref_Reserve  (HPDF_Xref  xref,
+                    HPDF_UINT  count)
+{
+    HPDF_UINT blocks = (xref->count + count + HPDF_XREF_ENTRIES_PER_BLOCK - 1) /
+            HPDF_XREF_ENTRIES_PER_BLOCK;
+
+    HPDF_PTRACE((" HPDF_Xref_Reserve\n"));
+
+    return HPDF_List_Reserve (xref->entry_blocks, blocks);
+}
+
+
 HPDF_XrefEntry
 HPDF_Xref_GetEntry  (HPDF_Xref  xref,
                      HPDF_UINT  index)
 {
+    HPDF_XrefEntry block;
+
     HPDF_PTRACE((" HPDF_Xref_GetEntry\n"));
 
-    return (HPDF_XrefEntry)HPDF_List_ItemAt(xref->entries, index);
+    if (index >= xref->count)
+        return NULL;
+
+    block = (HPDF_XrefEntry)xref->entry_blocks->obj[index /
+            HPDF_XREF_ENTRIES_PER_BLOCK];
+
+    return block + index % HPDF_XREF_ENTRIES_PER_BLOCK;
 }
 
 
@@ -192,31 +252,95 @@ HPDF_Xref_GetEntryByObjectId  (HPDF_Xref  xref,
 
     HPDF_PTRACE((" HPDF_Xref_GetEntryByObjectId\n"));
 
+    /* each xref section holds a continuous range of object ids */
     while (tmp_xref) {
-        HPDF_UINT i;
-
-        if (tmp_xref->entries->count + tmp_xref->start_offset > obj_id) {
-            HPDF_SetError (xref->error, HPDF_INVALID_OBJ_ID, 0);
-            return NULL;
-        }
-
-        if (tmp_xref->start_offset < obj_id) {
-            for (i = 0; i < tmp_xref->entries->count; i++) {
-                if (tmp_xref->start_offset + i == obj_id) {
-                    HPDF_XrefEntry entry = HPDF_Xref_GetEntry(tmp_xref, i);
-
-                    return entry;
-                }
-            }
-        }
+        if (obj_id >= tmp_xref->start_offset &&
+                obj_id - tmp_xref->start_offset < tmp_xref->count)
+            return HPDF_Xref_GetEntry (tmp_xref,
+                    obj_id - tmp_xref->start_offset);
 
         tmp_xref = tmp_xref->prev;
     }
 
+    HPDF_SetError (xref->error, HPDF_INVALID_OBJ_ID, 0);
     return NULL;
 }
 
 
+static HPDF_STATUS
+WriteObject  (HPDF_XrefEntry  entry,
+              HPDF_UINT       obj_id,
+              HPDF_Stream     stream,
+              HPDF_Encrypt    e)
+{
+    HPDF_STATUS ret;
+    char buf[HPDF_SHORT_BUF_SIZ];
+    char* pbuf;
+    char* eptr = buf + HPDF_SHORT_BUF_SIZ - 1;
+    HPDF_UINT16 gen_no = entry->gen_no;
+
+    entry->byte_offset = stream->size;
+
+    pbuf = buf;
+    pbuf = HPDF_IToA (pbuf, obj_id, eptr);
+    *pbuf++ = ' ';
+    pbuf = HPDF_IToA (pbuf, gen_no, eptr);
+    HPDF_StrCpy(pbuf, " obj\012", eptr);
+
+    if ((ret = HPDF_Stream_WriteStr (stream, buf)) != HPDF_OK)
+       return ret;
+
+    if (e)
+        HPDF_Encrypt_InitKey (e, obj_id, gen_no);
+
+    if ((ret = HPDF_Obj_WriteValue (entry->obj, stream, e)) != HPDF_OK)
+        return ret;
+
+    return HPDF_Stream_WriteStr (stream, "\012endobj\012");
+}
+
+
+/*
+ *  HPDF_Xref_FlushObject
+ *
+ *  write an indirect object to the stream ahead of HPDF_Xref_WriteToStream.
+ *  the entry remembers its byte offset and is skipped when the rest of
+ *  the document is written. used by progressive save.
+ *
+ */
+HPDF_STATUS
+HPDF_Xref_FlushObject  (HPDF_Xref     xref,
+                        void          *obj,
+                        HPDF_Stream   stream)
+{
+    HPDF_Obj_Header *header = (HPDF_Obj_Header *)obj;
+    HPDF_UINT obj_id;
+    HPDF_XrefEntry entry;
+    HPDF_STATUS ret;
+
+    HPDF_PTRACE((" HPDF_Xref_FlushObject\n"));
+
+    if (!obj || !(header->obj_id & HPDF_OTYPE_INDIRECT))
+        return HPDF_SetError (xref->error, HPDF_INVALID_OBJECT, 0);
+
+    obj_id = header->obj_id & 0x00FFFFFF;
+
+    entry = HPDF_Xref_GetEntryByObjectId (xref, obj_id);
+    if (!entry)
+        return HPDF_Error_GetCode (xref->error);
+
+    if (entry->flushed)
+        return HPDF_OK;
+
+    if ((ret = WriteObject (entry, obj_id, stream, NULL)) != HPDF_OK)
+        return ret;
+
+    entry->flushed = HPDF_TRUE;
+
+    return HPDF_OK;
+}
+
+
 HPDF_STATUS
 HPDF_Xref_WriteToStream  (HPDF_Xref    xref,
                           HPDF_Stream  stream,
@@ -240,33 +364,17 @@ HPDF_Xref_WriteToStream  (HPDF_Xref    xref,
         else
             str_idx = 0;
 
-        for (i = str_idx; i < tmp_xref->entries->count; i++) {
-            HPDF_XrefEntry  entry =
-                        (HPDF_XrefEntry)HPDF_List_ItemAt (tmp_xref->entries, i);
-            HPDF_UINT obj_id = tmp_xref->start_offset + i;
-            HPDF_UINT16 gen_no = entry->gen_no;
+        for (i = str_idx; i < tmp_xref->count; i++) {
+            HPDF_XrefEntry  entry = HPDF_Xref_GetEntry (tmp_xref, i);
 
-            entry->byte_offset = stream->size;
-
-            pbuf = buf;
-            pbuf = HPDF_IToA (pbuf, obj_id, eptr);
-            *pbuf++ = ' ';
-            pbuf = HPDF_IToA (pbuf, gen_no, eptr);
-            HPDF_StrCpy(pbuf, " obj\012", eptr);
+            /* objects flushed by progressive save keep their byte_offset */
+            if (entry->flushed)
+                continue;
 
-            if ((ret = HPDF_Stream_WriteStr (stream, buf)) != HPDF_OK)
-               return ret;
-
-            if (e)
-                HPDF_Encrypt_InitKey (e, obj_id, gen_no);
-
-            if ((ret = HPDF_Obj_WriteValue (entry->obj, stream, e)) != HPDF_OK)
+            if ((ret = WriteObject (entry, tmp_xref->start_offset + i, stream,
+                    e)) != HPDF_OK)
                 return ret;
-
-            if ((ret = HPDF_Stream_WriteStr (stream, "\012endobj\012"))
-                    != HPDF_OK)
-                return ret;
-       }
+        }
 
        tmp_xref = tmp_xref->prev;
     }
@@ -282,13 +390,13 @@ HPDF_Xref_WriteToStream  (HPDF_Xref    xref,
         pbuf = (char *)HPDF_StrCpy (pbuf, "xref\012", eptr);
         pbuf = HPDF_IToA (pbuf, tmp_xref->start_offset, eptr);
         *pbuf++ = ' ';
-        pbuf = HPDF_IToA (pbuf, tmp_xref->entries->count, eptr);
+        pbuf = HPDF_IToA (pbuf, tmp_xref->count, eptr);
         HPDF_StrCpy (pbuf, "\012", eptr);
         ret = HPDF_Stream_WriteStr (stream, buf);
         if (ret != HPDF_OK)
             return ret;
 
-        for (i = 0; i < tmp_xref->entries->count; i++) {
+        for (i = 0; i < tmp_xref->count; i++) {
             HPDF_XrefEntry entry = HPDF_Xref_GetEntry(tmp_xref, i);
 
             pbuf = buf;
@@ -323,7 +431,7 @@ WriteTrailer  (HPDF_Xref     xref,
     if (!xref)
         return HPDF_INVALID_OBJECT;
 
-    max_obj_id = xref->entries->count + xref->start_offset;
+    max_obj_id = xref->count + xref->start_offset;
 
     HPDF_PTRACE ((" WriteTrailer\n"));
 
@@ -0,0 +1,38 @@
+#ifndef PDF_CREATOR_COLUMN_WIDTH_SOLVER_H
+#define PDF_CREATOR_COLUMN_WIDTH_SOLVER_H
+
+#include "pdfcreator/font_metrics.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ *  Расчет ширины столбцов таблицы по содержимому (аналог автоматической раскладки таблиц в HTML).
+ *  Для каждого столбца собираются два ограничения по всем переданным строкам:
+ *    min_width - ширина самого длинного слова (уже не стоит: слова начнут разрываться посередине)
+ *    max_width - ширина самого длинного текста без переносов
+ *  Затем ширина таблицы распределяется между столбцами в соответствии с этими ограничениями.
+ */
+class ColumnWidthSolver {
+public:
+    ColumnWidthSolver(const FontMetrics& metrics, HPDF_REAL font_size, HPDF_REAL padding);
+
+    void AddRow(const std::vector<std::string>& row_fields);
+    std::vector<HPDF_REAL> Solve(HPDF_REAL table_width) const;
+
+private:
+    struct ColumnConstraints {
+        HPDF_INT min_advance = 0;   // самое длинное слово, в единицах глифового пространства
+        HPDF_INT max_advance = 0;   // самый длинный текст, в единицах глифового пространства
+    };
+
+    void AddField(size_t column, std::string_view field);
+
+    const FontMetrics& metrics_;
+    const HPDF_REAL font_size_;
+    const HPDF_REAL padding_;
+    std::vector<ColumnConstraints> columns_;
+};
+
+#endif
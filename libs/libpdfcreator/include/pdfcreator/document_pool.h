@@ -0,0 +1,68 @@
+#ifndef PDF_CREATOR_DOCUMENT_POOL_H
+#define PDF_CREATOR_DOCUMENT_POOL_H
+
+#include "pdfcreator/pdfcreator.h"
+
+#include <memory>
+#include <vector>
+
+/*
+ *  Пул документов для серии отчетов в одном потоке.
+ *  Вместо создания и уничтожения HPDF_Doc на каждый отчет документ после использования сбрасывается
+ *  (PDFDocument::Reset) и выдается следующему отчету: память документа libharu, блоки арены и загруженные
+ *  шрифты используются повторно. Пул не синхронизирован - каждый поток работает со своим пулом (ThreadLocal).
+ */
+class DocumentPool {
+public:
+    // документ, выданный пулом; при уничтожении возвращается в пул
+    class Lease {
+    public:
+        Lease(Lease&& other) noexcept
+            : pool_(other.pool_), document_(std::move(other.document_)) {
+            other.pool_ = nullptr;
+        }
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+
+        ~Lease() {
+            if (pool_) pool_->Release(std::move(document_));
+        }
+
+        PDFDocument& operator*() const { return *document_; }
+        PDFDocument* operator->() const { return document_.get(); }
+
+    private:
+        friend class DocumentPool;
+
+        Lease(DocumentPool* pool, std::unique_ptr<PDFDocument> document)
+            : pool_(pool), document_(std::move(document)) {}
+
+        DocumentPool* pool_;
+        std::unique_ptr<PDFDocument> document_;
+    };
+
+    // max_idle - сколько сброшенных документов пул хранит между отчетами
+    explicit DocumentPool(const CompressionSettings& compression = CompressionSettings(),
+                          const AllocatorSettings& allocator = AllocatorSettings(),
+                          size_t max_idle = 1);
+
+    // пул текущего потока: документы с ареной и последовательным сжатием (настройки по умолчанию)
+    static DocumentPool& ThreadLocal();
+
+    // пустой документ: сброшенный из пула или новый, если свободных нет
+    Lease Acquire();
+
+    DocumentPool(const DocumentPool&) = delete;
+    DocumentPool& operator=(const DocumentPool&) = delete;
+
+private:
+    void Release(std::unique_ptr<PDFDocument> document);
+
+    CompressionSettings compression_;
+    AllocatorSettings allocator_;
+    size_t max_idle_;
+    std::vector<std::unique_ptr<PDFDocument>> idle_;
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef PDF_CREATOR_FONT_METRICS_H
+#define PDF_CREATOR_FONT_METRICS_H
+
+#include <hpdf.h>
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+#include <unordered_map>
+
+/*
+ *  Кэш ширин глифов шрифта.
+ *  Каждая кодовая точка декодируется и запрашивается у libharu один раз, после чего ширина берется из таблицы.
+ *  Для латиницы и кириллицы (U+0000..U+04FF) используется плотный массив, остальные символы хранятся в хэш-таблице.
+ *  Ширины хранятся в единицах глифового пространства (1/1000 кегля), как их возвращает libharu,
+ *  поэтому результат TextWidth совпадает с HPDF_Page_TextWidth при нулевых char_space/word_space.
+ */
+class FontMetrics {
+public:
+    FontMetrics() = default;
+    explicit FontMetrics(HPDF_Font font);
+
+    void Reset(HPDF_Font font);
+
+    // ширина кодовой точки в единицах глифового пространства
+    HPDF_INT GetAdvance(char32_t codepoint) const;
+    // ширина UTF-8 текста в "пикселях" для заданного размера шрифта
+    HPDF_REAL TextWidth(std::string_view text, HPDF_REAL font_size) const;
+    // ширина текста в единицах глифового пространства
+    HPDF_INT TextAdvance(std::string_view text) const;
+
+    // декодирует кодовую точку, начинающуюся с позиции pos, и возвращает позицию следующей
+    // (некорректная последовательность дает U+FFFD и сдвиг на один байт)
+    static size_t NextCodepoint(std::string_view text, size_t pos, char32_t& codepoint);
+    // находит конец "символа" (кодовая точка вместе со следующими за ней комбинируемыми знаками),
+    // начинающегося с позиции pos, и его ширину; по этим границам разрешено разбивать слово
+    size_t NextCluster(std::string_view text, size_t pos, HPDF_INT& advance) const;
+
+    static HPDF_REAL ToWidth(HPDF_INT advance, HPDF_REAL font_size) {
+        return advance * font_size / 1000;
+    }
+
+private:
+    static constexpr char32_t kDenseRange = 0x0500;   // Basic Latin .. Cyrillic
+    static constexpr HPDF_INT kUnknownAdvance = -1;
+
+    HPDF_INT QueryAdvance(char32_t codepoint) const;
+
+    HPDF_Font font_ = nullptr;
+    // таблицы заполняются лениво: libharu помечает запрошенные глифы как используемые при встраивании шрифта
+    mutable std::array<HPDF_INT, kDenseRange> dense_advances_{};
+    mutable std::unordered_map<char32_t, HPDF_INT> sparse_advances_;
+};
+
+#endif
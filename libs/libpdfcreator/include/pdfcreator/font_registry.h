@@ -0,0 +1,34 @@
+#ifndef PDF_CREATOR_FONT_REGISTRY_H
+#define PDF_CREATOR_FONT_REGISTRY_H
+
+#include <hpdf.h>
+
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/*
+ *  Общий для процесса реестр TrueType-шрифтов.
+ *  Файл шрифта читается и разбирается (hmtx, cmap, loca, name...) один раз при первом обращении, после чего
+ *  шрифт не изменяется, и его одновременно используют документы из любых потоков.
+ *  Документ подключает шрифт через HPDF_LoadSharedTTFont и хранит у себя только набор использованных глифов.
+ */
+class FontRegistry {
+public:
+    static FontRegistry& Instance();
+
+    // разобранный шрифт из файла path; nullptr, если файл не удалось прочитать или разобрать
+    HPDF_SharedTTFont Get(std::string_view path);
+
+    FontRegistry(const FontRegistry&) = delete;
+    FontRegistry& operator=(const FontRegistry&) = delete;
+
+private:
+    FontRegistry() = default;
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, HPDF_SharedTTFont> fonts_;
+};
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef PDF_CREATOR_LINE_BREAKER_H
+#define PDF_CREATOR_LINE_BREAKER_H
+
+#include "pdfcreator/font_metrics.h"
+
+#include <string>
+#include <string_view>
+
+/*
+ *  Разбиение текста на строки по словам за линейное время.
+ *  Ширина текущей строки накапливается в единицах глифового пространства, поэтому каждое слово измеряется
+ *  ровно один раз, а строка не пересобирается и не перемеряется целиком.
+ *  Готовые строки передаются в sink по мере заполнения: sink(const std::string& line).
+ *  Буфер строки переиспользуется, так что после "прогрева" разбиение не выделяет память.
+ */
+class LineBreaker {
+public:
+    LineBreaker(const FontMetrics& metrics, HPDF_REAL font_size, HPDF_REAL available_width)
+        : metrics_(metrics)
+        , font_size_(font_size)
+        , available_width_(available_width)
+        , space_advance_(metrics.GetAdvance(' '))
+    {};
+
+    template <typename Sink>
+    void Break(std::string_view text, Sink&& sink) {
+        size_t word_start = 0;
+        for (size_t pos = 0; pos < text.size(); ++pos) {
+            const char ch = text[pos];
+            if (ch != ' ' && ch != '\t' && ch != '\n') continue;
+
+            // для разделителей обрабатываем накопленное слово
+            if (pos > word_start) {
+                AddWord(text.substr(word_start, pos - word_start), sink);
+            }
+            word_start = pos + 1;
+
+            // перевод строки завершает текущую строку (даже пустую)
+            if (ch == '\n') {
+                EmitLine(sink);
+            }
+        }
+
+        // последнее слово и оставшаяся строка
+        if (word_start < text.size()) {
+            AddWord(text.substr(word_start), sink);
+        }
+        if (!line_.empty()) {
+            EmitLine(sink);
+        }
+    }
+
+private:
+    bool Fits(HPDF_INT advance) const {
+        return FontMetrics::ToWidth(advance, font_size_) <= available_width_;
+    }
+
+    template <typename Sink>
+    void EmitLine(Sink& sink) {
+        sink(static_cast<const std::string&>(line_));
+        line_.clear();
+        line_advance_ = 0;
+    }
+
+    template <typename Sink>
+    void AddWord(std::string_view word, Sink& sink) {
+        const HPDF_INT word_advance = metrics_.TextAdvance(word);
+
+        // проверяем, помещается ли слово в текущую строку
+        if (!line_.empty()) {
+            if (Fits(line_advance_ + space_advance_ + word_advance)) {
+                line_ += ' ';
+                line_ += word;
+                line_advance_ += space_advance_ + word_advance;
+                return;
+            }
+            // переносим текущую строку и начинаем новую с этого слова
+            EmitLine(sink);
+        }
+
+        if (Fits(word_advance)) {
+            line_ = word;
+            line_advance_ = word_advance;
+            return;
+        }
+
+        // слово не помещается даже в пустую строку - разбиваем его по границам символов UTF-8
+        size_t pos = 0;
+        while (pos < word.size()) {
+            HPDF_INT char_advance;
+            const size_t next = metrics_.NextCluster(word, pos, char_advance);
+            const std::string_view single_char = word.substr(pos, next - pos);
+            pos = next;
+
+            if (!Fits(char_advance)) {
+                // если даже один символ не помещается - пропускаем
+                continue;
+            }
+            if (!Fits(line_advance_ + char_advance)) {
+                EmitLine(sink);
+            }
+            line_ += single_char;
+            line_advance_ += char_advance;
+        }
+    }
+
+    const FontMetrics& metrics_;
+    const HPDF_REAL font_size_;
+    const HPDF_REAL available_width_;
+    const HPDF_INT space_advance_;
+
+    std::string line_;
+    HPDF_INT line_advance_ = 0;
+};
+
+#endif
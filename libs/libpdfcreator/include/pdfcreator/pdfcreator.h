@@ -4,6 +4,11 @@
 #include <hpdf.h>
 #include <json.hpp>
 
+#include <memory_resource>
+
+#include "pdfcreator/font_metrics.h"
+#include "pdfcreator/table_grid.h"
+
 using json = nlohmann::json;
 
 constexpr std::string_view kFont = "Times-Roman";  // шрифт по умолчанию
@@ -11,6 +16,9 @@ constexpr std::string_view kFontPath = "/home/user/dir/PDFCreator/fonts/JetBrain
 constexpr HPDF_REAL kFontSize = 11.0;              // размер шрифта документа
 constexpr HPDF_REAL kFontSizeTableRow = 7.0;       // размер шрифта в строке таблицы
 constexpr HPDF_REAL kLineSpacing = 10.0;           // межстрочный интервал
+constexpr HPDF_REAL kPageDecorationFontSize = 6.0; // размер шрифта колонтитулов
+constexpr HPDF_REAL kPageDecorationOffset = 9.0;   // расстояние от края страницы до базовой линии колонтитула (в пределах kMargin)
+constexpr std::string_view kPageNumberSample = "Страница 9999 из 9999";  // образец, по которому резервируется место под номер страницы
 
 constexpr HPDF_REAL kStartPosX = 20;               // начальное положение курсора
 constexpr HPDF_REAL kStartPosY = 20;               // начальное положение курсора
@@ -18,55 +26,208 @@ constexpr HPDF_REAL kMargin = 20;                  // размер вообра
 
 constexpr HPDF_REAL kBorderWidth = 0.5;            // толщина линии рамки таблицы
 constexpr HPDF_REAL kLeftRightPadding = 4.0;       // "заполнитель" слева и справа текста, который не дает ему прилипнуть к рамке
+constexpr size_t kColumnWidthSampleRows = 100;     // количество строк таблицы, по которым рассчитывается ширина столбцов
+
+
+// Описание таблицы для потокового добавления строк (PDFDocument::BeginTable)
+struct TableSchema {
+    std::vector<std::string> headers;       // заголовки столбцов (повторяются на каждой новой странице)
+    std::vector<HPDF_REAL> column_widths;   // ширины столбцов; если пусто - одинаковые для всех столбцов
+    HPDF_REAL font_size = kFontSizeTableRow;
+};
+
+// Строка текста в заданной позиции страницы (PDFDocument::AddTextRuns)
+struct TextRun {
+    HPDF_REAL x;
+    HPDF_REAL y;
+    std::string_view text;      // UTF-8, завершающая '\0' не нужна
+};
+
+// Сжатие (deflate) одного класса потоков документа
+struct StreamCompression {
+    int level = HPDF_COMP_LEVEL_DEFAULT;    // уровень zlib: 1 - быстрее, 9 - меньше размер; 0 - поток не сжимается
+    HPDF_DeflateStrategy strategy = HPDF_DEFLATE_DEFAULT;
+};
+
+// Сжатие потоков документа по классам (PDFDocument)
+struct CompressionSettings {
+    StreamCompression content;  // потоки содержимого страниц
+    StreamCompression fonts;    // программы шрифтов и CMap
+    StreamCompression images;
+    // потоки, сжимающие содержимое при сохранении: 1 - только вызывающий поток, 0 - по числу ядер процессора.
+    // Потоки создаются на каждое сохранение, поэтому по умолчанию сжатие последовательное: документы
+    // обычно строятся одновременно в нескольких потоках (DocumentPool::ThreadLocal)
+    unsigned threads = 1;
+
+    // быстрая выгрузка (интерактивный экспорт)
+    static CompressionSettings Fast() {
+        CompressionSettings settings;
+        settings.content.level = settings.fonts.level = settings.images.level = HPDF_COMP_LEVEL_SPEED;
+        return settings;
+    }
+    // параллельное сжатие при сохранении для крупного разового отчета (threads = 0 - по числу ядер)
+    static CompressionSettings Parallel(unsigned threads = 0) {
+        CompressionSettings settings;
+        settings.threads = threads;
+        return settings;
+    }
+    // наименьший размер файла (архив)
+    static CompressionSettings Archive() {
+        CompressionSettings settings;
+        settings.content.level = settings.fonts.level = settings.images.level = HPDF_COMP_LEVEL_BEST;
+        settings.images.strategy = HPDF_DEFLATE_FILTERED;
+        return settings;
+    }
+};
+
+// Распределение памяти документа (объекты, словари и потоки libharu)
+struct AllocatorSettings {
+    // начальный размер блока арены: объекты размещаются подряд в блоках, каждый следующий блок вдвое больше
+    // предыдущего (до HPDF_MAX_MPOOL_BUF_SIZ), память возвращается только при уничтожении документа.
+    // 0 - каждый объект выделяется и освобождается отдельно.
+    // Арена не освобождает память сброшенных страниц, поэтому с BeginProgressiveSave ее не используют
+    HPDF_UINT arena_block_size = 0;
+    // источник памяти (при включенной арене - для ее блоков); nullptr - malloc/free
+    std::pmr::memory_resource* resource = nullptr;
+
+    // арена для документа с таблицей примерно из expected_rows строк
+    static AllocatorSettings Arena(size_t expected_rows);
+};
 
+class PDFTable;
 
 class IDocument {
 public:
     virtual ~IDocument() = default;
 
+    virtual void AddHeader(const std::string& text) = 0;
+    virtual void AddFooter(const std::string& text) = 0;
     virtual void AddJSON(const json& header_fields) = 0;
     virtual void AddText(const std::string& text) = 0;
     virtual void AddTableRow(float font_size, const std::vector<std::string>& row_fields, const std::vector<std::string> &headers) = 0;
     virtual void AddTableHeaders(float font_size, const std::vector<std::string>& headers) = 0;
+    virtual void AddTable(float font_size, const std::vector<std::string>& headers, const std::vector<std::vector<std::string>>& rows) = 0;
     virtual void SaveToFile(const std::string& file_path) = 0;
 };
 
 class PDFDocument : public IDocument {
 public:
-    PDFDocument();
+    explicit PDFDocument(const CompressionSettings& compression = CompressionSettings(),
+                         const AllocatorSettings& allocator = AllocatorSettings());
 
+    // Колонтитулы выводятся в верхнем и нижнем поле текущей и всех следующих страниц.
+    // Нижний колонтитул дополняется номером страницы "Страница N из M"; пустой верхний колонтитул не выводится
+    void AddHeader(const std::string& text) override;
+    void AddFooter(const std::string& text) override;
     void AddJSON(const json& header_fields) override;
     void AddText(const std::string& text) override;
     void AddTableRow(float font_size, const std::vector<std::string>& row_fields, const std::vector<std::string> &headers) override;
     void AddTableHeaders(float font_size, const std::vector<std::string>& headers) override;
+    void AddTable(float font_size, const std::vector<std::string>& headers, const std::vector<std::vector<std::string>>& rows) override;
     void SaveToFile(const std::string& file_path) override;
 
+    // Потоковое добавление таблицы: заголовок размечается один раз, строки не накапливаются в памяти.
+    // Одновременно может быть открыта только одна таблица
+    PDFTable BeginTable(const TableSchema& schema);
+    // Ширины столбцов, рассчитанные по содержимому заголовка и строк-образцов (см. ColumnWidthSolver)
+    std::vector<HPDF_REAL> CalcColumnWidths(HPDF_REAL font_size, const std::vector<std::string>& headers,
+                                            const std::vector<std::vector<std::string>>& sample_rows) const;
+    // Постраничная запись в файл: содержимое каждой заполненной страницы сбрасывается на диск при переходе
+    // на новую страницу, остальная часть документа дописывается в SaveToFile с тем же путем
+    void BeginProgressiveSave(const std::string& file_path);
+    // Вывод набора строк текста на текущую страницу одним текстовым объектом: состояние страницы проверяется
+    // один раз, позиции записываются относительными смещениями Td
+    void AddTextRuns(const TextRun* runs, size_t count);
+    // Сброс к пустому документу для построения следующего отчета без повторного создания документа libharu
+    void Reset();
+
     ~PDFDocument() override;
 
 private:
+    friend class PDFTable;
+
+    void AddFirstPage();
     void AddNewPage();
+    void StampPage();
+    void FillPageTotal();
+    void WritePageDecoration(const TextRun* runs, size_t count);
+    void SetupCompression(const CompressionSettings& compression);
+    void LoadFont();
     void SetupFont();
 
-    int CalcTextRowsInCell(const std::string& field_text, size_t chars_per_line);
-    int CalcTextWidthInCell(HPDF_REAL cell_width, HPDF_REAL text_width, int symbols);
-    HPDF_REAL CalcBaseColumnWidth(const std::vector<std::string> &row_fields) const;
-    HPDF_REAL CalcMaxColumnHeight(HPDF_REAL base_row_height, HPDF_REAL base_column_width, HPDF_REAL font_size, const std::vector<std::string> &row_fields);
+    HPDF_REAL CalcBaseColumnWidth(size_t columns_count) const;
+    const std::vector<HPDF_REAL>& GetColumnWidths(size_t columns_count);
+
+    // разбивка строки таблицы на строки текста в ячейках (одна на строку таблицы)
+    struct CellLayout {
+        std::vector<std::string_view> lines;    // строки текста ячейки, указывают на исходный текст поля
+    };
+    struct RowLayout {
+        std::vector<CellLayout> cells;
+        HPDF_REAL font_size = 0;
+        HPDF_REAL height = 0;                   // точная высота строки таблицы с учетом переносов
+    };
+    void LayoutRow(HPDF_REAL font_size, const std::vector<HPDF_REAL> &column_widths, const std::vector<std::string> &row_fields, RowLayout &layout);
+    void LayoutRow(HPDF_REAL font_size, const std::vector<HPDF_REAL> &column_widths, const std::string_view *row_fields, size_t fields_count, RowLayout &layout) const;
+    void LayoutCell(std::string_view field, HPDF_REAL available_width, HPDF_REAL font_size, CellLayout &cell) const;
 
     // для создания строки таблицы
-    HPDF_REAL DrawTableRaw(HPDF_REAL max_row_height, HPDF_REAL table_width, HPDF_REAL base_column_width, const std::vector<std::string> &row_fields) const;
-    void AddTextToTableRow(HPDF_REAL row_height, HPDF_REAL font_size, const std::vector<std::string> &row_fields);
-    void AddMultilineTextInCell(HPDF_REAL x_pos_in_row, HPDF_REAL base_column_width, HPDF_REAL row_height, HPDF_REAL font_size, const std::string& field) const;
-    // void AddMultilineTextInCell(HPDF_REAL x_pos_in_row, HPDF_REAL base_column_width, HPDF_REAL font_size, const std::string& field) const;
-    void AddSingleLineTextInCell(HPDF_REAL x_pos_in_row, HPDF_REAL row_height, HPDF_REAL font_size, const std::string& field) const;
+    HPDF_REAL DrawTableRaw(const RowLayout &layout, HPDF_REAL table_width, const std::vector<HPDF_REAL> &column_widths);
+    void AddTextToTableRow(const RowLayout &layout, const std::vector<HPDF_REAL> &column_widths);
+    void AddMultilineTextInCell(HPDF_REAL x_pos_in_row, HPDF_REAL row_height, HPDF_REAL font_size, const CellLayout& cell);
+    void AddSingleLineTextInCell(HPDF_REAL x_pos_in_row, HPDF_REAL row_height, HPDF_REAL font_size, std::string_view line);
+    void AddTextRun(HPDF_REAL x, HPDF_REAL y, std::string_view text);
+    void ShowTextRuns();
+    void PlaceTableRow(const RowLayout &layout, const std::vector<HPDF_REAL> &column_widths);
+    void PlaceTableHeader(const RowLayout &layout, const std::vector<HPDF_REAL> &column_widths, HPDF_XObject &form);
+    HPDF_XObject RecordTableHeader(const RowLayout &layout, const std::vector<HPDF_REAL> &column_widths, HPDF_REAL table_width);
+    void SetTableFont(HPDF_REAL font_size);
+
+    // для потокового добавления таблицы (PDFTable)
+    void AddTableRow(const std::string_view *row_fields, size_t fields_count);
+    void EndTable();
+    void ReserveTablePages(size_t rows);
 
     // для работы с текстом вне таблицы
     void PrintTextWithWrap(const std::string& text);
-    void ProcessWord(std::string& word, std::string& current_line, std::vector<std::string>& lines, HPDF_REAL available_width);
 
 private:
     HPDF_Doc pdf_;
     HPDF_Page page_;
     HPDF_Font font_;
+    std::string font_name_; // имя загруженного TrueType-шрифта (пусто - используется kFont)
+    bool arena_ = false;    // память документа выделяется ареной (AllocatorSettings::arena_block_size)
+    FontMetrics metrics_;   // кэш ширин глифов текущего шрифта
+
+    RowLayout row_layout_;      // разбивка текущей строки таблицы (память переиспользуется между строками)
+    RowLayout header_layout_;   // разбивка заголовка таблицы (строки указывают на header_fields_)
+    std::vector<std::string> header_fields_;    // заголовки последнего вызова AddTableHeaders
+    HPDF_XObject header_form_ = nullptr;        // текст этого заголовка, записанный формой при первом выводе
+    TableGrid grid_;            // рамки таблиц текущей страницы, записываются одним путем при смене страницы
+    std::vector<HPDF_REAL> equal_column_widths_;   // одинаковые ширины столбцов для AddTableRow
+    std::vector<std::string_view> field_views_;    // представления полей строки из std::vector<std::string>
+    std::vector<HPDF_TextRun> text_runs_;   // строки текста, накопленные для одного вызова HPDF_Page_ShowTextRuns
+    std::string progressive_path_;  // файл постраничной записи (пусто - документ пишется целиком в SaveToFile)
+
+    // колонтитулы: общий для всех страниц текст записывается одним потоком содержимого (page_template_),
+    // который подключается к каждой странице; номер страницы пишется в отдельный небольшой поток страницы
+    std::string page_header_;
+    std::string page_footer_;
+    bool page_numbers_ = false;         // нижний колонтитул задан - выводятся номера страниц
+    HPDF_Dict page_template_ = nullptr; // общий поток колонтитулов (nullptr - еще не записан)
+    HPDF_XObject page_total_ = nullptr; // общее число страниц: форма на всех страницах, заполняется при сохранении
+    size_t page_number_ = 1;
+    bool page_stamped_ = false;         // колонтитулы текущей страницы уже выведены
+
+    // открытая таблица (BeginTable)
+    struct Table {
+        bool active = false;
+        HPDF_REAL font_size = 0;
+        std::vector<std::string> headers;
+        std::vector<HPDF_REAL> column_widths;
+        RowLayout header_layout;    // заголовок размечается один раз и повторяется на каждой странице
+        HPDF_XObject header_form = nullptr; // текст заголовка, записанный формой при первом выводе
+    } table_;
 
     struct Cursor {
         HPDF_REAL x = kStartPosX;
@@ -74,17 +235,54 @@ private:
     } cursor_;
 };
 
+/*
+ *  Открытая таблица документа. Строки передаются как набор string_view и сразу выводятся на страницу.
+ *  Таблица завершается вызовом End() или при уничтожении объекта.
+ */
+class PDFTable {
+public:
+    PDFTable(PDFTable&& other) noexcept
+        : document_(other.document_) {
+        other.document_ = nullptr;
+    }
+    PDFTable(const PDFTable&) = delete;
+    PDFTable& operator=(const PDFTable&) = delete;
+    PDFTable& operator=(PDFTable&&) = delete;
+
+    ~PDFTable() {
+        End();
+    }
+
+    void AddRow(const std::string_view* row_fields, size_t fields_count);
+    void AddRow(std::initializer_list<std::string_view> row_fields) {
+        AddRow(row_fields.begin(), row_fields.size());
+    }
+    void AddRow(const std::vector<std::string_view>& row_fields) {
+        AddRow(row_fields.data(), row_fields.size());
+    }
+    void End();
+
+private:
+    friend class PDFDocument;
+    explicit PDFTable(PDFDocument& document)
+        : document_(&document)
+    {};
+
+    PDFDocument* document_;
+};
+
 class IBuilder {
 public:
     virtual ~IBuilder() = default;
 
-    virtual void AddHeader() {};
-    virtual void AddFooter() {};
+    virtual void AddHeader(const std::string&) {};
+    virtual void AddFooter(const std::string&) {};
 
     virtual void AddJSON(const json& header_fields) {};
     virtual void AddText(const std::string& text) {};
     virtual void AddTableRow(float font_size, const std::vector<std::string>& row_fields, const std::vector<std::string> &headers) {};
     virtual void AddTableHeaders(float font_size, const std::vector<std::string>& headers) {};
+    virtual void AddTable(float, const std::vector<std::string>&, const std::vector<std::vector<std::string>>&) {};
 
     virtual IDocument* GetDocument() = 0;
 };
@@ -94,6 +292,14 @@ public:
     PDFBuilder() = default;
     ~PDFBuilder() override = default;
 
+    void AddHeader(const std::string& text) override {
+        document_.AddHeader(text);
+    };
+
+    void AddFooter(const std::string& text) override {
+        document_.AddFooter(text);
+    };
+
     void AddJSON(const json& header_fields) override {
         document_.AddJSON(header_fields);
     };
@@ -110,6 +316,10 @@ public:
         document_.AddTableHeaders(font_size, headers);
     };
 
+    void AddTable(float font_size, const std::vector<std::string>& headers, const std::vector<std::vector<std::string>>& rows) override {
+        document_.AddTable(font_size, headers, rows);
+    };
+
     IDocument* GetDocument() override {
         return &document_;
     };
@@ -151,6 +361,8 @@ public:
     ~TestPDFDirector() override = default;
 
     void CreateDocument() override {
+        builder_.AddHeader("Annual Report");
+        builder_.AddFooter("Джон Доу, 2023-05-15");
         builder_.AddJSON( json::parse(
         R"(
             [
@@ -0,0 +1,51 @@
+#ifndef PDF_CREATOR_TABLE_GRID_H
+#define PDF_CREATOR_TABLE_GRID_H
+
+#include <hpdf.h>
+
+#include <vector>
+
+/*
+ *  Сетка рамок таблицы на одной странице.
+ *  Строки таблицы не рисуются по отдельности, а добавляются в сетку: общая граница соседних строк хранится
+ *  один раз, а подряд идущие строки с одинаковыми столбцами образуют блок, вертикальные линии которого
+ *  проходят сразу через все его строки. Накопленная сетка записывается в поток страницы одним путем (Flush).
+ */
+class TableGrid {
+public:
+    // рамка строки таблицы: left/right - левая и правая границы, top/bottom - верхняя и нижняя,
+    // column_widths - ширины ячеек (вертикальные линии начинаются от left)
+    void AddRow(HPDF_REAL left, HPDF_REAL right, HPDF_REAL top, HPDF_REAL bottom,
+                const std::vector<HPDF_REAL>& column_widths);
+
+    // запись сетки в поток страницы (вне текстового объекта) и очистка
+    void Flush(HPDF_Page page, HPDF_REAL line_width);
+    void Clear();
+
+    bool Empty() const {
+        return blocks_.empty();
+    }
+
+private:
+    struct HorizontalLine {
+        HPDF_REAL y;
+        HPDF_REAL left;
+        HPDF_REAL right;
+    };
+    // подряд идущие строки с одинаковыми столбцами
+    struct Block {
+        size_t first_x;     // координаты вертикальных линий блока: xs_[first_x, first_x + x_count)
+        size_t x_count;
+        HPDF_REAL top;
+        HPDF_REAL bottom;
+    };
+
+    bool ContinuesLastBlock(HPDF_REAL left, HPDF_REAL right, HPDF_REAL top,
+                            const std::vector<HPDF_REAL>& column_widths) const;
+
+    std::vector<HorizontalLine> horizontal_;
+    std::vector<HPDF_REAL> xs_;
+    std::vector<Block> blocks_;
+};
+
+#endif
@@ -0,0 +1,83 @@
+#include "pdfcreator/column_width_solver.h"
+
+#include <algorithm>
+
+ColumnWidthSolver::ColumnWidthSolver(const FontMetrics& metrics, HPDF_REAL font_size, HPDF_REAL padding)
+    : metrics_(metrics)
+    , font_size_(font_size)
+    , padding_(padding)
+{}
+
+void ColumnWidthSolver::AddRow(const std::vector<std::string>& row_fields) {
+    if (columns_.size() < row_fields.size()) {
+        columns_.resize(row_fields.size());
+    }
+    for (size_t i = 0; i < row_fields.size(); ++i) {
+        AddField(i, row_fields[i]);
+    }
+}
+
+void ColumnWidthSolver::AddField(size_t column, std::string_view field) {
+    ColumnConstraints& constraints = columns_[column];
+    const HPDF_INT space_advance = metrics_.GetAdvance(' ');
+
+    HPDF_INT text_advance = 0;
+    HPDF_INT word_advance = 0;
+    for (size_t pos = 0; pos < field.size();) {
+        const char ch = field[pos];
+        if (ch == ' ' || ch == '\t' || ch == '\n') {
+            constraints.min_advance = std::max(constraints.min_advance, word_advance);
+            word_advance = 0;
+            text_advance += space_advance;
+            ++pos;
+            continue;
+        }
+
+        HPDF_INT char_advance;
+        pos = metrics_.NextCluster(field, pos, char_advance);
+        word_advance += char_advance;
+        text_advance += char_advance;
+    }
+    constraints.min_advance = std::max(constraints.min_advance, word_advance);
+    constraints.max_advance = std::max(constraints.max_advance, text_advance);
+}
+
+/*
+ *  Распределение ширины таблицы между столбцами
+ *  table_width - ширина таблицы (сумма ширин столбцов всегда равна ей)
+ */
+std::vector<HPDF_REAL> ColumnWidthSolver::Solve(HPDF_REAL table_width) const {
+    const size_t columns_count = columns_.size();
+    std::vector<HPDF_REAL> widths(columns_count);
+    if (columns_count == 0) return widths;
+
+    std::vector<HPDF_REAL> min_widths(columns_count);
+    std::vector<HPDF_REAL> max_widths(columns_count);
+    HPDF_REAL sum_min = 0;
+    HPDF_REAL sum_max = 0;
+    for (size_t i = 0; i < columns_count; ++i) {
+        min_widths[i] = FontMetrics::ToWidth(columns_[i].min_advance, font_size_) + 2 * padding_;
+        max_widths[i] = FontMetrics::ToWidth(columns_[i].max_advance, font_size_) + 2 * padding_;
+        sum_min += min_widths[i];
+        sum_max += max_widths[i];
+    }
+
+    if (sum_max <= table_width) {
+        // весь текст помещается без переносов - свободное место распределяем пропорционально содержимому
+        for (size_t i = 0; i < columns_count; ++i) {
+            widths[i] = max_widths[i] + (table_width - sum_max) * max_widths[i] / sum_max;
+        }
+    } else if (sum_min >= table_width) {
+        // даже самые длинные слова не помещаются - сжимаем пропорционально, слова будут разрываться
+        for (size_t i = 0; i < columns_count; ++i) {
+            widths[i] = min_widths[i] * table_width / sum_min;
+        }
+    } else {
+        // каждый столбец получает минимум и долю остатка, пропорциональную его "желанию" расшириться
+        const HPDF_REAL extra = (table_width - sum_min) / (sum_max - sum_min);
+        for (size_t i = 0; i < columns_count; ++i) {
+            widths[i] = min_widths[i] + (max_widths[i] - min_widths[i]) * extra;
+        }
+    }
+    return widths;
+}
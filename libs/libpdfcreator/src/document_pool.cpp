@@ -0,0 +1,39 @@
+#include "pdfcreator/document_pool.h"
+
+namespace {
+// типичный отчет - несколько сотен строк таблицы
+constexpr size_t kThreadLocalExpectedRows = 500;
+}
+
+DocumentPool::DocumentPool(const CompressionSettings& compression, const AllocatorSettings& allocator,
+                           size_t max_idle)
+    : compression_(compression), allocator_(allocator), max_idle_(max_idle) {}
+
+DocumentPool& DocumentPool::ThreadLocal() {
+    thread_local DocumentPool pool(CompressionSettings(), AllocatorSettings::Arena(kThreadLocalExpectedRows));
+    return pool;
+}
+
+DocumentPool::Lease DocumentPool::Acquire() {
+    if (!idle_.empty()) {
+        std::unique_ptr<PDFDocument> document = std::move(idle_.back());
+        idle_.pop_back();
+        return Lease(this, std::move(document));
+    }
+    return Lease(this, std::make_unique<PDFDocument>(compression_, allocator_));
+}
+
+void DocumentPool::Release(std::unique_ptr<PDFDocument> document) {
+    if (!document || idle_.size() >= max_idle_) {
+        return;
+    }
+
+    // документ сбрасывается сразу, чтобы память отчета не удерживалась до следующего Acquire;
+    // документ, который не удалось сбросить, уничтожается
+    try {
+        document->Reset();
+    } catch (const std::exception&) {
+        return;
+    }
+    idle_.push_back(std::move(document));
+}
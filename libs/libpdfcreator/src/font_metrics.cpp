@@ -0,0 +1,131 @@
+#include "pdfcreator/font_metrics.h"
+
+namespace {
+
+constexpr char32_t kReplacementChar = 0xFFFD;
+
+bool IsTrailByte(unsigned char byte) {
+    return (byte & 0xC0) == 0x80;
+}
+
+// комбинируемые диакритические знаки и селекторы вариантов не отделяются от предыдущего символа
+bool IsCombiningMark(char32_t codepoint) {
+    return (codepoint >= 0x0300 && codepoint <= 0x036F) ||   // Combining Diacritical Marks
+           (codepoint >= 0x0483 && codepoint <= 0x0489) ||   // Cyrillic combining marks (титло и т.п.)
+           (codepoint >= 0x1AB0 && codepoint <= 0x1AFF) ||
+           (codepoint >= 0x1DC0 && codepoint <= 0x1DFF) ||
+           (codepoint >= 0x20D0 && codepoint <= 0x20FF) ||
+           (codepoint >= 0xFE00 && codepoint <= 0xFE0F) ||   // Variation Selectors
+           (codepoint >= 0xFE20 && codepoint <= 0xFE2F);
+}
+
+}  // namespace
+
+FontMetrics::FontMetrics(HPDF_Font font) {
+    Reset(font);
+}
+
+void FontMetrics::Reset(HPDF_Font font) {
+    font_ = font;
+    dense_advances_.fill(kUnknownAdvance);
+    sparse_advances_.clear();
+}
+
+size_t FontMetrics::NextCodepoint(std::string_view text, size_t pos, char32_t& codepoint) {
+    const auto lead = static_cast<unsigned char>(text[pos]);
+    const size_t rest = text.size() - pos;
+
+    // ASCII
+    if (lead < 0x80) {
+        codepoint = lead;
+        return pos + 1;
+    }
+
+    // двухбайтовые последовательности (в т.ч. вся кириллица)
+    if ((lead & 0xE0) == 0xC0) {
+        if (rest >= 2 && lead >= 0xC2 && IsTrailByte(text[pos + 1])) {
+            codepoint = (char32_t(lead & 0x1F) << 6) | (text[pos + 1] & 0x3F);
+            return pos + 2;
+        }
+    } else if ((lead & 0xF0) == 0xE0) {
+        if (rest >= 3 && IsTrailByte(text[pos + 1]) && IsTrailByte(text[pos + 2])) {
+            codepoint = (char32_t(lead & 0x0F) << 12) | (char32_t(text[pos + 1] & 0x3F) << 6) | (text[pos + 2] & 0x3F);
+            if (codepoint >= 0x800 && (codepoint < 0xD800 || codepoint > 0xDFFF)) {
+                return pos + 3;
+            }
+        }
+    } else if ((lead & 0xF8) == 0xF0) {
+        if (rest >= 4 && IsTrailByte(text[pos + 1]) && IsTrailByte(text[pos + 2]) && IsTrailByte(text[pos + 3])) {
+            codepoint = (char32_t(lead & 0x07) << 18) | (char32_t(text[pos + 1] & 0x3F) << 12) |
+                        (char32_t(text[pos + 2] & 0x3F) << 6) | (text[pos + 3] & 0x3F);
+            if (codepoint >= 0x10000 && codepoint <= 0x10FFFF) {
+                return pos + 4;
+            }
+        }
+    }
+
+    codepoint = kReplacementChar;
+    return pos + 1;
+}
+
+size_t FontMetrics::NextCluster(std::string_view text, size_t pos, HPDF_INT& advance) const {
+    char32_t codepoint;
+    pos = NextCodepoint(text, pos, codepoint);
+    advance = GetAdvance(codepoint);
+
+    while (pos < text.size() && static_cast<unsigned char>(text[pos]) >= 0x80) {
+        const size_t next = NextCodepoint(text, pos, codepoint);
+        if (!IsCombiningMark(codepoint)) break;
+        advance += GetAdvance(codepoint);
+        pos = next;
+    }
+    return pos;
+}
+
+HPDF_INT FontMetrics::QueryAdvance(char32_t codepoint) const {
+    // libharu работает только с BMP
+    return HPDF_Font_GetUnicodeWidth(font_, static_cast<HPDF_UNICODE>(codepoint));
+}
+
+HPDF_INT FontMetrics::GetAdvance(char32_t codepoint) const {
+    if (codepoint < kDenseRange) {
+        HPDF_INT& advance = dense_advances_[codepoint];
+        if (advance == kUnknownAdvance) {
+            advance = QueryAdvance(codepoint);
+        }
+        return advance;
+    }
+
+    auto it = sparse_advances_.find(codepoint);
+    if (it == sparse_advances_.end()) {
+        it = sparse_advances_.emplace(codepoint, QueryAdvance(codepoint)).first;
+    }
+    return it->second;
+}
+
+HPDF_INT FontMetrics::TextAdvance(std::string_view text) const {
+    HPDF_INT advance = 0;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        const auto byte = static_cast<unsigned char>(text[pos]);
+        // быстрый путь для ASCII без декодирования
+        if (byte < 0x80) {
+            HPDF_INT& cached = dense_advances_[byte];
+            if (cached == kUnknownAdvance) {
+                cached = QueryAdvance(byte);
+            }
+            advance += cached;
+            ++pos;
+            continue;
+        }
+
+        char32_t codepoint;
+        pos = NextCodepoint(text, pos, codepoint);
+        advance += GetAdvance(codepoint);
+    }
+    return advance;
+}
+
+HPDF_REAL FontMetrics::TextWidth(std::string_view text, HPDF_REAL font_size) const {
+    return ToWidth(TextAdvance(text), font_size);
+}
@@ -0,0 +1,25 @@
+#include "pdfcreator/font_registry.h"
+
+FontRegistry& FontRegistry::Instance() {
+    // реестр и шрифты не освобождаются: документ, уничтожаемый при завершении процесса,
+    // может обратиться к данным шрифта позже деструкторов статических объектов
+    static FontRegistry* registry = new FontRegistry();
+    return *registry;
+}
+
+HPDF_SharedTTFont FontRegistry::Get(std::string_view path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const std::string key(path);
+    auto it = fonts_.find(key);
+    if (it != fonts_.end()) {
+        return it->second;
+    }
+
+    // неудачная загрузка не запоминается: файл может появиться позже
+    HPDF_SharedTTFont font = HPDF_NewSharedTTFont(key.c_str());
+    if (font) {
+        fonts_.emplace(key, font);
+    }
+    return font;
+}
@@ -1,7 +1,51 @@
 #include "pdfcreator/pdfcreator.h"
+#include "pdfcreator/column_width_solver.h"
+#include "pdfcreator/font_registry.h"
+#include "pdfcreator/line_breaker.h"
 #include "utf8/utf8.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
+#include <thread>
+
+namespace {
+
+// объем памяти документа на строку таблицы (объекты страниц, текст строки в потоке содержимого)
+constexpr size_t kArenaBytesPerRow = 1024;
+constexpr size_t kArenaMinBlockSize = 64 * 1024;
+constexpr size_t kArenaMaxBlockSize = 4 * 1024 * 1024;  // libharu не увеличивает блоки сверх HPDF_MAX_MPOOL_BUF_SIZ
+
+// pmr::memory_resource::deallocate требует размер блока, а libharu передает только указатель:
+// размер хранится в заголовке перед блоком
+constexpr size_t kResourceHeaderSize = alignof(std::max_align_t);
+
+void* HPDF_STDCALL ResourceAlloc(void* resource, HPDF_UINT size) {
+    try {
+        auto* block = static_cast<std::byte*>(static_cast<std::pmr::memory_resource*>(resource)->allocate(
+            size + kResourceHeaderSize, alignof(std::max_align_t)));
+        *reinterpret_cast<size_t*>(block) = size;
+        return block + kResourceHeaderSize;
+    } catch (...) {
+        // исключение не должно пройти через libharu: нехватка памяти сообщается через nullptr
+        return nullptr;
+    }
+}
+
+void HPDF_STDCALL ResourceFree(void* resource, void* ptr) {
+    auto* block = static_cast<std::byte*>(ptr) - kResourceHeaderSize;
+    const size_t size = *reinterpret_cast<size_t*>(block);
+    static_cast<std::pmr::memory_resource*>(resource)->deallocate(block, size + kResourceHeaderSize, alignof(std::max_align_t));
+}
+
+}  // namespace
+
+AllocatorSettings AllocatorSettings::Arena(size_t expected_rows) {
+    AllocatorSettings settings;
+    settings.arena_block_size = static_cast<HPDF_UINT>(std::clamp<size_t>(
+        expected_rows * kArenaBytesPerRow, kArenaMinBlockSize, kArenaMaxBlockSize));
+    return settings;
+}
 
 const std::vector<std::string> TestPDFDirector::kHeaders_ = {
     "ID",
@@ -15,21 +59,59 @@ const std::vector<std::string> TestPDFDirector::kHeaders_ = {
     "Пользователь"
 };
 
-PDFDocument::PDFDocument() {
-    pdf_ = HPDF_New(nullptr, nullptr);
+PDFDocument::PDFDocument(const CompressionSettings& compression, const AllocatorSettings& allocator) {
+    pdf_ = allocator.resource
+        ? HPDF_NewWithAllocator(nullptr, ResourceAlloc, ResourceFree, allocator.resource, allocator.arena_block_size, nullptr)
+        : HPDF_NewEx(nullptr, nullptr, nullptr, allocator.arena_block_size, nullptr);
     if (!pdf_) {
         throw std::runtime_error("Error creating pdf document");
     }
 
+    arena_ = allocator.arena_block_size != 0;
+
+    // сжатие задается до создания страниц и шрифтов: фильтр потока выбирается при его создании
+    SetupCompression(compression);
+
     // Настройка параметров страницы и курсора
-    page_ = HPDF_AddPage(pdf_);
-    if (!page_) {
-        throw std::runtime_error("Error creating new page in pdf");
-    }
-    HPDF_Page_SetSize(page_, HPDF_PAGE_SIZE_A4, HPDF_PAGE_PORTRAIT);
-    cursor_.y = HPDF_Page_GetHeight(page_) - kStartPosY;
+    AddFirstPage();
 
     // Настройка шрифта
+    LoadFont();
+    SetupFont();
+}
+
+/*
+ *  Подготовка документа к следующему отчету: страницы и объекты документа освобождаются, настройки сжатия
+ *  и распределения памяти сохраняются. Без арены определения шрифтов и кодировки остаются загруженными;
+ *  в арене они освобождаются вместе с остальной памятью и подключаются заново (разобранный файл шрифта берется
+ *  из FontRegistry), а блоки арены используются повторно без обращения к malloc.
+ *  Открытая таблица (PDFTable) должна быть завершена до вызова.
+ */
+void PDFDocument::Reset() {
+    if (HPDF_ResetDoc(pdf_) != HPDF_OK) {
+        throw std::runtime_error("Error resetting pdf document");
+    }
+
+    row_layout_ = RowLayout();
+    header_layout_ = RowLayout();
+    header_fields_.clear();
+    header_form_ = nullptr;
+    grid_.Clear();
+    text_runs_.clear();
+    progressive_path_.clear();
+    page_header_.clear();
+    page_footer_.clear();
+    page_numbers_ = false;
+    page_template_ = nullptr;
+    page_total_ = nullptr;
+    page_number_ = 1;
+    page_stamped_ = false;
+    table_ = Table();
+
+    AddFirstPage();
+    if (arena_) {
+        LoadFont();
+    }
     SetupFont();
 }
 
@@ -76,46 +158,11 @@ void PDFDocument::PrintTextWithWrap(const std::string& text) {
     // Получаем доступную ширину для текста (ширина страницы минус левый и правый отступы)
     const HPDF_REAL page_width = HPDF_Page_GetWidth(page_);
     const HPDF_REAL available_width = page_width - 2 * kMargin;
+    const HPDF_REAL font_size = HPDF_Page_GetCurrentFontSize(page_);
 
-    // Разбиваем текст на строки, которые помещаются в доступную ширину
-    std::vector<std::string> lines;
-    std::string current_line;
-    std::string current_word;
-
-    for (char ch : text) {
-        if (ch == ' ' || ch == '\t' || ch == '\n') {
-            // Для существующих разделителей обрабатываем накопленное слово
-            if (!current_word.empty()) {
-                ProcessWord(current_word, current_line, lines, available_width);
-            }
-
-            // Обрабатываем перевод строки отдельно,
-            // чтобы завершить формирование текущей строки, так как встретили "перевод строки"
-            if (ch == '\n') {
-                if (!current_line.empty()) {
-                    lines.push_back(current_line);
-                    current_line.clear();
-                } else {
-                    lines.push_back("");
-                }
-            }
-        } else {
-            current_word += ch;
-        }
-    }
-
-    // Добавляем последнее слово, если оно есть
-    if (!current_word.empty()) {
-        ProcessWord(current_word, current_line, lines, available_width);
-    }
-
-    // Добавляем оставшуюся строку
-    if (!current_line.empty()) {
-        lines.push_back(current_line);
-    }
-
-    // Печатаем все строки
-    for (const auto& line : lines) {
+    // Разбиваем текст на строки, которые помещаются в доступную ширину, и сразу печатаем их
+    LineBreaker line_breaker(metrics_, font_size, available_width);
+    line_breaker.Break(text, [this](const std::string& line) {
         // Проверяем, нужно ли создать новую страницу
         if (cursor_.y < kMargin) {
             AddNewPage();
@@ -125,55 +172,48 @@ void PDFDocument::PrintTextWithWrap(const std::string& text) {
         HPDF_Page_TextOut(page_, kStartPosX, cursor_.y, line.c_str());
         HPDF_Page_EndText(page_);
         cursor_.y -= kFontSize + kLineSpacing;
-    }
+    });
 }
 
-void PDFDocument::ProcessWord(std::string& word, std::string& current_line,
-                            std::vector<std::string>& lines, HPDF_REAL available_width) {
-    // Проверяем, помещается ли слово в текущую строку
-    std::string test_line = current_line.empty() ? word : current_line + " " + word;
-    HPDF_REAL text_width = HPDF_Page_TextWidth(page_, test_line.c_str());
+void PDFDocument::SaveToFile(const std::string &file_path) {
+    grid_.Flush(page_, kBorderWidth);
+    StampPage();
+    FillPageTotal();
 
-    if (text_width <= available_width) {
-        current_line = test_line;
-    } else {
-        // Если слово слишком длинное и не помещается даже в пустую строку
-        if (current_line.empty()) {
-            // Разбиваем слово посимвольно
-            for (char ch : word) {
-                std::string single_char(1, ch);
-                HPDF_REAL char_width = HPDF_Page_TextWidth(page_, single_char.c_str());
-
-                if (char_width > available_width) {
-                    // Если даже один символ не помещается - пропускаем
-                    continue;
-                }
-
-                test_line = current_line + single_char;
-                text_width = HPDF_Page_TextWidth(page_, test_line.c_str());
-
-                if (text_width <= available_width) {
-                    current_line = test_line;
-                } else {
-                    lines.push_back(current_line);
-                    current_line = single_char;
-                }
-            }
-            word.clear();
-        } else {
-            // Переносим текущую строку и начинаем новую с этого слова
-            lines.push_back(current_line);
-            current_line = word;
-        }
+    if (progressive_path_.empty()) {
+        HPDF_SaveToFile(pdf_, file_path.data());
+        return;
+    }
+
+    // страницы уже записаны в файл, указанный при BeginProgressiveSave - дописываем остальные объекты
+    if (file_path != progressive_path_) {
+        throw std::runtime_error("Progressive save was started for another file: " + progressive_path_);
+    }
+    progressive_path_.clear();
+    if (HPDF_EndProgressiveSave(pdf_) != HPDF_OK) {
+        throw std::runtime_error("Error saving pdf document");
     }
-    word.clear();
 }
 
-void PDFDocument::SaveToFile(const std::string &file_path) {
-    HPDF_SaveToFile(pdf_, file_path.data());
+void PDFDocument::BeginProgressiveSave(const std::string &file_path) {
+    if (!progressive_path_.empty()) {
+        throw std::runtime_error("Progressive save is already started");
+    }
+    if (HPDF_BeginProgressiveSave(pdf_, file_path.data()) != HPDF_OK) {
+        throw std::runtime_error("Error opening file for progressive save: " + file_path);
+    }
+    progressive_path_ = file_path;
 }
 
 void PDFDocument::AddNewPage() {
+    grid_.Flush(page_, kBorderWidth);
+    StampPage();
+
+    // заполненная страница больше не изменяется - ее содержимое можно сразу записать на диск
+    if (!progressive_path_.empty() && HPDF_FlushPage(pdf_, page_) != HPDF_OK) {
+        throw std::runtime_error("Error writing page to file: " + progressive_path_);
+    }
+
     page_ = HPDF_AddPage(pdf_);
     if (!page_) {
         throw std::runtime_error("Error creating new page in pdf");
@@ -181,112 +221,286 @@ void PDFDocument::AddNewPage() {
     HPDF_Page_SetSize(page_, HPDF_PAGE_SIZE_A4, HPDF_PAGE_PORTRAIT);
     cursor_.y = HPDF_Page_GetHeight(page_) - kMargin;
     HPDF_Page_SetFontAndSize(page_, font_, kFontSize);
+    ++page_number_;
+    page_stamped_ = false;
 }
 
-void PDFDocument::SetupFont() {
-    const char *font_name = HPDF_LoadTTFontFromFile(
-        pdf_, kFontPath.data(), HPDF_TRUE);
+void PDFDocument::AddHeader(const std::string& text) {
+    page_header_ = text;
+    page_template_ = nullptr;
+}
+
+void PDFDocument::AddFooter(const std::string& text) {
+    page_footer_ = text;
+    page_numbers_ = true;
+    page_template_ = nullptr;
+}
+
+/*
+ *  Вывод колонтитулов заполненной страницы (при переходе на новую страницу и при сохранении).
+ *  Общий текст колонтитулов записывается в отдельный поток содержимого один раз, остальные страницы ссылаются
+ *  на него (HPDF_Page_Insert_Shared_Content_Stream). После общего потока страница продолжается новым потоком,
+ *  в который попадает только номер страницы.
+ *  Поток ссылается на шрифт по имени ресурса страницы: шрифт документа выбирается первым на каждой странице
+ *  (AddNewPage), поэтому имя у него везде одинаковое.
+ */
+void PDFDocument::StampPage() {
+    if (page_stamped_ || (page_header_.empty() && !page_numbers_)) return;
+    page_stamped_ = true;
+
+    const HPDF_REAL page_width = HPDF_Page_GetWidth(page_);
+    const HPDF_REAL page_height = HPDF_Page_GetHeight(page_);
+
+    TextRun runs[2];
+    size_t runs_count = 0;
+    if (!page_header_.empty()) {
+        runs[runs_count++] = {kStartPosX, page_height - kPageDecorationOffset, page_header_};
+    }
+    if (!page_footer_.empty()) {
+        runs[runs_count++] = {kStartPosX, kPageDecorationOffset, page_footer_};
+    }
+
+    if (runs_count == 0) {
+        // общего текста нет - только поток с номером страницы
+        if (HPDF_Page_New_Content_Stream(page_, nullptr) != HPDF_OK) {
+            throw std::runtime_error("Error creating page content stream");
+        }
+    } else if (!page_template_) {
+        if (HPDF_Page_New_Content_Stream(page_, &page_template_) != HPDF_OK) {
+            throw std::runtime_error("Error creating page header stream");
+        }
+        WritePageDecoration(runs, runs_count);
+        if (HPDF_Page_New_Content_Stream(page_, nullptr) != HPDF_OK) {
+            throw std::runtime_error("Error creating page content stream");
+        }
+    } else if (HPDF_Page_Insert_Shared_Content_Stream(page_, page_template_) != HPDF_OK) {
+        throw std::runtime_error("Error adding page header stream");
+    }
+
+    if (page_numbers_) {
+        // "Страница N из M": общее число страниц M становится известно только при сохранении, поэтому вместо него
+        // выводится форма page_total_, которую заполняет FillPageTotal. Ширина M заранее не известна,
+        // и блок начинается с постоянной позиции, рассчитанной по образцу
+        const std::string number = "Страница " + std::to_string(page_number_) + " из ";
+        const HPDF_REAL x = page_width - kMargin - metrics_.TextWidth(kPageNumberSample, kPageDecorationFontSize);
+
+        if (!page_total_) {
+            const HPDF_Rect bbox = {0, -kPageDecorationFontSize, page_width, kPageDecorationFontSize};
+            page_total_ = HPDF_Page_BeginFormXObject(page_, bbox);
+            if (!page_total_ || HPDF_Page_EndFormXObject(page_) != HPDF_OK) {
+                throw std::runtime_error("Error creating page total form");
+            }
+        }
+
+        const TextRun run = {x, kPageDecorationOffset, number};
+        HPDF_Page_GSave(page_);
+        HPDF_Page_SetFontAndSize(page_, font_, kPageDecorationFontSize);
+        AddTextRuns(&run, 1);
+        HPDF_Page_Concat(page_, 1, 0, 0, 1, x + metrics_.TextWidth(number, kPageDecorationFontSize), kPageDecorationOffset);
+        HPDF_Page_ExecuteXObject(page_, page_total_);
+        HPDF_Page_GRestore(page_);
+    }
+}
+
+/*
+ *  Запись общего числа страниц в форму, выведенную на всех страницах (при сохранении документа).
+ *  Страницы, добавленные после сохранения, получат новую форму.
+ */
+void PDFDocument::FillPageTotal() {
+    if (!page_total_) return;
+
+    if (HPDF_Page_ResumeFormXObject(page_, page_total_) != HPDF_OK) {
+        throw std::runtime_error("Error writing page total");
+    }
+    const std::string total = std::to_string(page_number_);
+    const TextRun run = {0, 0, total};
+    HPDF_Page_SetFontAndSize(page_, font_, kPageDecorationFontSize);
+    AddTextRuns(&run, 1);
+    if (HPDF_Page_EndFormXObject(page_) != HPDF_OK) {
+        throw std::runtime_error("Error writing page total");
+    }
+    page_total_ = nullptr;
+}
+
+void PDFDocument::WritePageDecoration(const TextRun* runs, size_t count) {
+    HPDF_Page_GSave(page_);
+    HPDF_Page_SetFontAndSize(page_, font_, kPageDecorationFontSize);
+    AddTextRuns(runs, count);
+    HPDF_Page_GRestore(page_);
+}
+
+void PDFDocument::SetupCompression(const CompressionSettings& compression) {
+    const struct {
+        HPDF_UINT mode;
+        const StreamCompression& settings;
+    } classes[] = {
+        {HPDF_COMP_TEXT, compression.content},
+        {HPDF_COMP_METADATA, compression.fonts},    // в libharu шрифты сжимаются по флагу METADATA
+        {HPDF_COMP_IMAGE, compression.images},
+    };
+
+    HPDF_UINT mode = HPDF_COMP_NONE;
+    for (const auto& c : classes) {
+        if (c.settings.level == 0) continue;
+        if (HPDF_SetCompressionParams(pdf_, c.mode, c.settings.level, c.settings.strategy) != HPDF_OK) {
+            throw std::runtime_error("Error setting compression parameters");
+        }
+        mode |= c.mode;
+    }
+
+    if (HPDF_SetCompressionMode(pdf_, mode) != HPDF_OK) {
+        throw std::runtime_error("Error setting compression mode");
+    }
+
+    // потоки страниц, шрифта и изображений независимы и при threads != 1 сжимаются параллельно перед записью в файл
+    const unsigned threads = compression.threads ? compression.threads : std::thread::hardware_concurrency();
+    if (HPDF_SetCompressionThreads(pdf_, threads) != HPDF_OK) {
+        throw std::runtime_error("Error setting compression threads");
+    }
+}
+
+void PDFDocument::AddFirstPage() {
+    page_ = HPDF_AddPage(pdf_);
+    if (!page_) {
+        throw std::runtime_error("Error creating new page in pdf");
+    }
+    HPDF_Page_SetSize(page_, HPDF_PAGE_SIZE_A4, HPDF_PAGE_PORTRAIT);
+    cursor_ = Cursor();
+    cursor_.y = HPDF_Page_GetHeight(page_) - kStartPosY;
+}
+
+/*
+ *  Подключение шрифта и кодировки UTF-8 к документу
+ */
+void PDFDocument::LoadFont() {
+    // файл шрифта разбирается один раз на процесс (FontRegistry), документ только подключает готовые таблицы
+    const HPDF_SharedTTFont shared_font = FontRegistry::Instance().Get(kFontPath);
+    const char *font_name = shared_font ? HPDF_LoadSharedTTFont(pdf_, shared_font, HPDF_TRUE) : nullptr;
     HPDF_UseUTFEncodings(pdf_);
-    font_ = HPDF_GetFont(pdf_, font_name, "UTF-8");
+    font_name_ = font_name ? font_name : "";
+}
+
+void PDFDocument::SetupFont() {
+    font_ = font_name_.empty() ? nullptr : HPDF_GetFont(pdf_, font_name_.c_str(), "UTF-8");
     if (!font_) {
         font_ = HPDF_GetFont(pdf_, kFont.data(), nullptr);
+    } else {
+        // таблица символ -> глиф на весь BMP (128 КБ): ширины и вывод текста не ищут по сегментам cmap
+        HPDF_Font_SetCMapDirectMode(font_, HPDF_TRUE);
     }
+    metrics_.Reset(font_);
     HPDF_Page_SetFontAndSize(page_, font_, kFontSize);
 }
 
 /*
- *  Расчет количества символов, которые поместятся в строку внутри ячейки с учетом ширины ячейки и шрифта
- *  cell_width - ширина ячейки в "пикселях"
- *  text_width - ширина текста в "пикселях" (учитывает шрифт текста, ведь он влияет на ширину символа)
- *  symbols    - количество символов в штуках
+ *  Расчет базовой ширины ячейки таблицы при условии, что все ячейки имеют одинаковую ширину
+ *  columns_count - количество ячеек в строке
  */
-int PDFDocument::CalcTextWidthInCell(HPDF_REAL cell_width, HPDF_REAL text_width, int symbols) {
-    return symbols * ((cell_width - 2 * kLeftRightPadding) / text_width);
+HPDF_REAL PDFDocument::CalcBaseColumnWidth(size_t columns_count) const {
+    return (HPDF_Page_GetWidth(page_) - 2 * kMargin) / columns_count;
 }
 
 /*
- *  Расчет количества строк, которые займет текст в ячейке с заданной шириной
- *  field_text     - непосредственно текст, который нужно запихнуть в ячейку
- *  chars_per_line - количество символов, которые поместятся в строку внутри ячейки с учетом ширины ячейки и шрифта
+ *  Одинаковые ширины столбцов для строки таблицы, добавляемой через AddTableRow
+ *  columns_count - количество ячеек в строке
  */
-int PDFDocument::CalcTextRowsInCell(const std::string& field_text, size_t chars_per_line) {
-    size_t start_pos = 0;
-    int counter = 0;
-    while (start_pos < field_text.length()) {
-        size_t end_pos = std::min(start_pos + chars_per_line, field_text.length());
-        std::string line = field_text.substr(start_pos, end_pos - start_pos);
-        start_pos = end_pos;
-        counter++;
+const std::vector<HPDF_REAL>& PDFDocument::GetColumnWidths(size_t columns_count) {
+    if (equal_column_widths_.size() != columns_count) {
+        equal_column_widths_.assign(columns_count, CalcBaseColumnWidth(columns_count));
     }
-    return counter;
+    return equal_column_widths_;
 }
 
 /*
- *  Расчет базовой ширины ячейки таблицы при условии, что все ячейки имеют одинаковую ширину
- *  row_fields - вектор строк с текстом каждой ячейки в строке
+ *  Разбивка строки таблицы: текст каждой ячейки делится на строки и рассчитывается точная высота строки таблицы.
+ *  Результат используется и для рисования рамок, и для вывода текста, поэтому текст измеряется один раз.
+ *  font_size - размер шрифта
+ *  column_widths - ширины ячеек таблицы
+ *  row_fields - текст каждой ячейки в строке (fields_count штук)
+ *  layout - результат (память переиспользуется между вызовами)
  */
-HPDF_REAL PDFDocument::CalcBaseColumnWidth(const std::vector<std::string> &row_fields) const {
-    return (HPDF_Page_GetWidth(page_) - 2 * kMargin) / row_fields.size();
+void PDFDocument::LayoutRow(HPDF_REAL font_size, const std::vector<HPDF_REAL> &column_widths, const std::vector<std::string> &row_fields, RowLayout &layout) {
+    field_views_.assign(row_fields.begin(), row_fields.end());
+    LayoutRow(font_size, column_widths, field_views_.data(), field_views_.size(), layout);
+}
+
+void PDFDocument::LayoutRow(HPDF_REAL font_size, const std::vector<HPDF_REAL> &column_widths, const std::string_view *row_fields, size_t fields_count, RowLayout &layout) const {
+    // высота строки по умолчанию - размер шрифтра и еще полразмера сверху и снизу
+    const HPDF_REAL base_row_height = font_size * 2;
+
+    layout.font_size = font_size;
+    layout.height = base_row_height;
+    layout.cells.resize(fields_count);
+
+    for (size_t i = 0; i < fields_count; ++i) {
+        CellLayout &cell = layout.cells[i];
+        // ширина, доступная тексту в ячейке (ширина ячейки за вычетом двух "заполнителей")
+        const HPDF_REAL available_width_of_cell = column_widths[i] - 2 * kLeftRightPadding;
+        LayoutCell(row_fields[i], available_width_of_cell, font_size, cell);
+
+        // каждая следующая строка текста увеличивает высоту строки таблицы на полтора размера шрифта
+        const HPDF_REAL required_height = cell.lines.size() * (base_row_height - font_size / 2.0) + font_size / 2.0;
+        layout.height = std::max(layout.height, required_height);
+    }
 }
 
 /*
- *  Расчет максимальной высоты ячейки таблицы, в которую поместятся все строки с учетом возможных переносов
- *  base_row_height - базовая высота ячейки таблицы (высота шрифта + две половины высоты шрифта)
- *  base_column_width - базовая ширина ячейки таблицы (высота шрифта + две половины высоты шрифта)
+ *  Разбивка текста ячейки на строки по границам символов UTF-8
+ *  field - текст ячейки
+ *  available_width - ширина, доступная тексту в ячейке
  *  font_size - размер шрифта
- *  row_fields - вектор строк с текстом каждой ячейки в строке
+ *  cell - результат
  */
-HPDF_REAL PDFDocument::CalcMaxColumnHeight(HPDF_REAL base_row_height, HPDF_REAL base_column_width, HPDF_REAL font_size, const std::vector<std::string> &row_fields) {
-    HPDF_REAL max_row_height = base_row_height;
-
-    for (const auto &field: row_fields) {
-        HPDF_REAL text_width = HPDF_Page_TextWidth(page_, field.c_str());
-        int text_rows_counter = 1;
-        // если ширина текста в ячейке больше ширины ячейки за вычетом двух "заполнителей"
-        if (text_width > (base_column_width - 2 * kLeftRightPadding)) {
-            // то придется переносить текст на следующую строку (строка таблицы начнет вмещать 2 и более строк текста)
-            // для этого сделаем высоту строки таблицы больше
-            text_rows_counter = CalcTextRowsInCell(field, CalcTextWidthInCell(base_column_width, text_width, field.length()));    //ceil(text_width / (base_column_width - 2 * kLeftRightPadding));
-            HPDF_REAL required_height = text_rows_counter * (base_row_height - font_size/2.0) + font_size/2.0;
-            max_row_height = std::max(max_row_height, required_height);
+void PDFDocument::LayoutCell(std::string_view field, HPDF_REAL available_width, HPDF_REAL font_size, CellLayout &cell) const {
+    cell.lines.clear();
+
+    size_t line_start = 0;
+    HPDF_REAL current_width = 0.0;
+    size_t pos = 0;
+    while (pos < field.size()) {
+        HPDF_INT char_advance;
+        const size_t next = metrics_.NextCluster(field, pos, char_advance);
+        const HPDF_REAL char_width = FontMetrics::ToWidth(char_advance, font_size);
+
+        // Если не удалось добавить ни одного символа (очень узкая колонка), берём хотя бы один символ
+        if (current_width + char_width > available_width && pos != line_start) {
+            cell.lines.push_back(field.substr(line_start, pos - line_start));
+            line_start = pos;
+            current_width = 0.0;
         }
+
+        current_width += char_width;
+        pos = next;
+    }
+
+    if (line_start < field.size()) {
+        cell.lines.push_back(field.substr(line_start));
     }
-    return max_row_height;
 }
 
 void PDFDocument::AddTableHeaders(float font_size, const std::vector<std::string>& headers) {
     HPDF_Page_SetFontAndSize(page_, font_, font_size);
 
-    // Параметры таблицы:
-    // ширина страницы
-    HPDF_REAL page_width = HPDF_Page_GetWidth(page_);
-    // ширина таблицы на странице (ширина страницы без левого и правого отступа от краев)
-    HPDF_REAL table_width = page_width - 2 * kMargin;
-    // ширина столбца в таблице
-    // TODO: динамическая ширина столбца
-    HPDF_REAL base_column_width = CalcBaseColumnWidth(headers);
-    // высота строки по умолчанию - размер шрифтра и еще полразмера сверху и снизу
-    HPDF_REAL base_row_height = font_size * 2;
-
-    // 1. Предварительный расчет максимальной высоты строки таблицы.
-    // Учитывает возможную необходимость переноса строки текста в рамках ячейки таблицы
-    HPDF_REAL max_row_height = CalcMaxColumnHeight(base_row_height, base_column_width, font_size, headers);
+    // ширины столбцов в таблице
+    const std::vector<HPDF_REAL> &column_widths = GetColumnWidths(headers.size());
+
+    // 1. Разбивка текста ячеек на строки и расчет высоты строки таблицы.
+    // Учитывает необходимость переноса строки текста в рамках ячейки таблицы.
+    // Тот же заголовок (при переносе таблицы на новую страницу) повторно не размечается и выводится
+    // ранее записанной формой; ширины столбцов зависят только от их числа
+    if (!header_form_ || header_layout_.font_size != font_size || header_fields_ != headers) {
+        header_fields_ = headers;
+        LayoutRow(font_size, column_widths, header_fields_, header_layout_);
+        header_form_ = nullptr;
+    }
 
     // 2. Проверка места на странице
-    if (cursor_.y - max_row_height < kMargin) {
+    if (cursor_.y - header_layout_.height < kMargin) {
         throw std::runtime_error(std::string("Failed to add table headers"));
     }
 
-    // 3. Рисуем границы таблицы
-    // y_bottom_of_row - координата Y нижней границы строки с учетом рассчитанной максимальной высоты строки
-    // (из текущей вертикальной координаты курсора вычитаем максимальную высоту строки)
-    const float y_bottom_of_row = DrawTableRaw(max_row_height, table_width, base_column_width, headers);
-
-    // 4. Добавляем текст
-    AddTextToTableRow(max_row_height, font_size, headers);
-
-    // 5. Обновляем позицию курсора
-    cursor_.y = y_bottom_of_row;
+    // 3. Рамки, текст и позиция курсора
+    PlaceTableHeader(header_layout_, column_widths, header_form_);
 }
 
 void PDFDocument::AddTableRow(HPDF_REAL font_size, const std::vector<std::string> &row_fields, const std::vector<std::string> &headers) {
@@ -297,18 +511,13 @@ void PDFDocument::AddTableRow(HPDF_REAL font_size, const std::vector<std::string
     HPDF_REAL page_width = HPDF_Page_GetWidth(page_);
     // ширина таблицы на странице (ширина страницы без левого и правого отступа от краев)
     HPDF_REAL table_width = page_width - 2 * kMargin;
-    // ширина столбца в таблице
-    // TODO: динамическая ширина столбца
-    HPDF_REAL base_column_width = CalcBaseColumnWidth(row_fields);
-    // высота строки по умолчанию - размер шрифтра и еще полразмера сверху и снизу
-    HPDF_REAL base_row_height = font_size * 2;
 
-    // 1. Предварительный расчет максимальной высоты строки таблицы.
-    // Учитывает возможную необходимость переноса строки текста в рамках ячейки таблицы
-    HPDF_REAL max_row_height = CalcMaxColumnHeight(base_row_height, base_column_width, font_size, row_fields);
+    // 1. Разбивка текста ячеек на строки и расчет высоты строки таблицы.
+    // Учитывает необходимость переноса строки текста в рамках ячейки таблицы
+    LayoutRow(font_size, GetColumnWidths(row_fields.size()), row_fields, row_layout_);
 
     // 2. Проверка места на странице
-    if (cursor_.y - max_row_height < kMargin) { //  kMargin + 2 * kLineSpacing
+    if (cursor_.y - row_layout_.height < kMargin) { //  kMargin + 2 * kLineSpacing
         try {
             AddNewPage();
             HPDF_Page_SetFontAndSize(page_, font_, font_size);
@@ -316,7 +525,7 @@ void PDFDocument::AddTableRow(HPDF_REAL font_size, const std::vector<std::string
             cursor_.y = HPDF_Page_GetHeight(page_) - kStartPosY;
             AddTableHeaders(font_size, headers);
             // Если даже после создания страницы не хватает места - ошибка
-            if (cursor_.y - max_row_height < kMargin) {
+            if (cursor_.y - row_layout_.height < kMargin) {
                 throw std::runtime_error("Header row is too large for the page");
             }
         } catch (const std::exception &e) {
@@ -325,103 +534,257 @@ void PDFDocument::AddTableRow(HPDF_REAL font_size, const std::vector<std::string
     }
 
     // 3. Рисуем границы таблицы
-    // y_bottom_of_row - координата Y нижней границы строки с учетом рассчитанной максимальной высоты строки
-    // (из текущей вертикальной координаты курсора вычитаем максимальную высоту строки)
-    const float y_bottom_of_row = DrawTableRaw(max_row_height, table_width, base_column_width, row_fields);
+    // y_bottom_of_row - координата Y нижней границы строки с учетом рассчитанной высоты строки
+    // (из текущей вертикальной координаты курсора вычитаем высоту строки).
+    // Ширины запрашиваются заново: перенос заголовка на новую страницу мог пересчитать их для другого числа столбцов
+    const float y_bottom_of_row = DrawTableRaw(row_layout_, table_width, GetColumnWidths(row_fields.size()));
 
     // 4. Добавляем текст
-    AddTextToTableRow(max_row_height, font_size, row_fields);
+    AddTextToTableRow(row_layout_, GetColumnWidths(row_fields.size()));
 
     // 5. Обновляем позицию курсора
     cursor_.y = y_bottom_of_row;
 }
 
-HPDF_REAL PDFDocument::DrawTableRaw(HPDF_REAL max_row_height, HPDF_REAL table_width, HPDF_REAL base_column_width, const std::vector<std::string> &row_fields) const {
-    HPDF_REAL y_bottom_of_row = cursor_.y - max_row_height;
-    HPDF_Page_SetLineWidth(page_, kBorderWidth);
+/*
+ *  Добавление таблицы целиком: ширины столбцов рассчитываются один раз по содержимому заголовка
+ *  и первых kColumnWidthSampleRows строк, после чего строки выводятся через BeginTable
+ *  font_size - размер шрифта
+ *  headers - заголовки столбцов (повторяются на каждой новой странице)
+ *  rows - строки таблицы
+ */
+void PDFDocument::AddTable(float font_size, const std::vector<std::string>& headers, const std::vector<std::vector<std::string>>& rows) {
+    if (headers.empty()) return;
+
+    PDFTable table = BeginTable({headers, CalcColumnWidths(font_size, headers, rows), font_size});
+    ReserveTablePages(rows.size());
+    for (const auto &row : rows) {
+        field_views_.assign(row.begin(), row.end());
+        table.AddRow(field_views_);
+    }
+}
 
-    // Горизонтальные линии
-    HPDF_Page_MoveTo(page_, kStartPosX, cursor_.y);
-    HPDF_Page_LineTo(page_, kStartPosX + table_width, cursor_.y); // на уровне курсора
+/*
+ *  Резервирование списков страниц и таблицы перекрестных ссылок libharu под rows строк открытой таблицы.
+ *  Число страниц оценивается по однострочным строкам, поэтому при переносах страниц может оказаться больше
+ */
+void PDFDocument::ReserveTablePages(size_t rows) {
+    const HPDF_REAL row_height = table_.font_size * 2;
+    const HPDF_REAL page_rows_height = HPDF_Page_GetHeight(page_) - kStartPosY - kMargin - table_.header_layout.height;
+    const size_t rows_per_page = std::max<size_t>(1, static_cast<size_t>(page_rows_height / row_height));
+    const size_t rows_on_current_page = static_cast<size_t>(std::max<HPDF_REAL>(0, cursor_.y - kMargin) / row_height);
+    if (rows <= rows_on_current_page) return;
+
+    const size_t pages = (rows - rows_on_current_page + rows_per_page - 1) / rows_per_page;
+    if (HPDF_ReservePages(pdf_, static_cast<HPDF_UINT>(pages)) != HPDF_OK) {
+        throw std::runtime_error("Error reserving pages in pdf");
+    }
+}
 
-    HPDF_Page_MoveTo(page_, kStartPosX, y_bottom_of_row);
-    HPDF_Page_LineTo(page_, kStartPosX + table_width, y_bottom_of_row); // на уровне нижней границы строки
+std::vector<HPDF_REAL> PDFDocument::CalcColumnWidths(HPDF_REAL font_size, const std::vector<std::string>& headers,
+                                                     const std::vector<std::vector<std::string>>& sample_rows) const {
+    ColumnWidthSolver solver(metrics_, font_size, kLeftRightPadding);
+    solver.AddRow(headers);
+    for (size_t i = 0; i < sample_rows.size() && i < kColumnWidthSampleRows; ++i) {
+        if (sample_rows[i].size() == headers.size()) {
+            solver.AddRow(sample_rows[i]);
+        }
+    }
+    return solver.Solve(HPDF_Page_GetWidth(page_) - 2 * kMargin);
+}
 
-    // Вертикальные линии
-    float x_pos_in_row = kStartPosX;
-    // здесь и далее определяет положение курсора при работе в рамках строки по горизонтали
-    for (size_t i = 0; i <= row_fields.size(); ++i) {
-        HPDF_Page_MoveTo(page_, x_pos_in_row, cursor_.y);
-        HPDF_Page_LineTo(page_, x_pos_in_row, y_bottom_of_row);
-        if (i < row_fields.size()) x_pos_in_row += base_column_width;
+PDFTable PDFDocument::BeginTable(const TableSchema& schema) {
+    if (table_.active) {
+        throw std::runtime_error("Failed to begin table: previous table is not finished");
     }
-    HPDF_Page_Stroke(page_);
-    return y_bottom_of_row;
+    if (schema.headers.empty()) {
+        throw std::runtime_error("Failed to begin table: no columns");
+    }
+    if (!schema.column_widths.empty() && schema.column_widths.size() != schema.headers.size()) {
+        throw std::runtime_error("Failed to begin table: column widths do not match headers");
+    }
+
+    table_.font_size = schema.font_size;
+    table_.header_form = nullptr;
+    table_.headers = schema.headers;
+    if (schema.column_widths.empty()) {
+        table_.column_widths.assign(schema.headers.size(), CalcBaseColumnWidth(schema.headers.size()));
+    } else {
+        table_.column_widths = schema.column_widths;
+    }
+
+    // Заголовок размечается один раз: строки разметки указывают на table_.headers
+    field_views_.assign(table_.headers.begin(), table_.headers.end());
+    LayoutRow(table_.font_size, table_.column_widths, field_views_.data(), field_views_.size(), table_.header_layout);
+
+    if (cursor_.y - table_.header_layout.height < kMargin) {
+        AddNewPage();
+    }
+    if (cursor_.y - table_.header_layout.height < kMargin) {
+        throw std::runtime_error("Failed to add table headers");
+    }
+    SetTableFont(table_.font_size);
+    PlaceTableHeader(table_.header_layout, table_.column_widths, table_.header_form);
+
+    table_.active = true;
+    return PDFTable(*this);
 }
 
-void PDFDocument::AddTextToTableRow(HPDF_REAL row_height, HPDF_REAL font_size, const std::vector<std::string> &row_fields) {
-    float x_pos_in_row = kStartPosX;
-    HPDF_Page_BeginText(page_);
-    HPDF_REAL base_column_width = CalcBaseColumnWidth(row_fields);
+void PDFDocument::AddTableRow(const std::string_view *row_fields, size_t fields_count) {
+    if (!table_.active) {
+        throw std::runtime_error("Failed to add table row: table is not started");
+    }
+    if (fields_count != table_.column_widths.size()) {
+        throw std::runtime_error("Failed to add table row: wrong number of fields");
+    }
 
-    for (const auto &field : row_fields) {
-        HPDF_REAL text_width = HPDF_Page_TextWidth(page_, field.c_str());
+    SetTableFont(table_.font_size);
 
-        if (text_width <= (base_column_width - 2 * kLeftRightPadding)) {
-            // Однострочный текст
-            AddSingleLineTextInCell(x_pos_in_row, row_height, font_size, field);
-        } else {
-            // Многострочный текст
-            AddMultilineTextInCell(x_pos_in_row, base_column_width, row_height, font_size, field);
+    // 1. Разбивка текста ячеек на строки и расчет высоты строки таблицы
+    LayoutRow(table_.font_size, table_.column_widths, row_fields, fields_count, row_layout_);
+
+    // 2. Проверка места на странице: на новой странице повторяем заранее размеченный заголовок
+    if (cursor_.y - row_layout_.height < kMargin) {
+        AddNewPage();
+        SetTableFont(table_.font_size);
+        PlaceTableHeader(table_.header_layout, table_.column_widths, table_.header_form);
+        if (cursor_.y - row_layout_.height < kMargin) {
+            throw std::runtime_error("Failed to add table row: row is too large for the page");
         }
-        x_pos_in_row += base_column_width;
     }
-    HPDF_Page_EndText(page_);
+
+    // 3. Рамки, текст и позиция курсора
+    PlaceTableRow(row_layout_, table_.column_widths);
 }
 
-void PDFDocument::AddSingleLineTextInCell(HPDF_REAL x_pos_in_row, HPDF_REAL row_height, HPDF_REAL font_size, const std::string& field) const {
-    HPDF_REAL text_x = x_pos_in_row + kLeftRightPadding;
-    HPDF_REAL text_y = cursor_.y - row_height / 2 - font_size / 3;
-    HPDF_Page_TextOut(page_, text_x, text_y, field.c_str());
+void PDFDocument::EndTable() {
+    table_.active = false;
+    grid_.Flush(page_, kBorderWidth);
 }
 
-void PDFDocument::AddMultilineTextInCell(HPDF_REAL x_pos_in_row, HPDF_REAL base_column_width, HPDF_REAL row_height, HPDF_REAL font_size, const std::string& field) const {
-    HPDF_REAL available_width_of_cell = base_column_width - 2 * kLeftRightPadding;
-    HPDF_REAL line_height = font_size * 1.2; // Высота одной строки текста с небольшим отступом
+/*
+ *  Вывод размеченной строки таблицы в текущей позиции курсора: рамки, текст и сдвиг курсора под строку
+ */
+void PDFDocument::PlaceTableRow(const RowLayout &layout, const std::vector<HPDF_REAL> &column_widths) {
+    const HPDF_REAL table_width = HPDF_Page_GetWidth(page_) - 2 * kMargin;
+    const float y_bottom_of_row = DrawTableRaw(layout, table_width, column_widths);
+    AddTextToTableRow(layout, column_widths);
+    cursor_.y = y_bottom_of_row;
+}
 
-    // Временный расчет количества строк
-    std::vector<std::string> lines;
-    auto it = field.begin();
-    while (it != field.end()) {
-        auto line_start = it;
-        auto line_end = it;
-        HPDF_REAL current_width = 0.0;
+/*
+ *  Вывод заголовка таблицы. Текст заголовка записывается в форму (Form XObject) при первом выводе, на следующих
+ *  страницах форма размещается одним оператором Do. Рамки заголовка добавляются в сетку страницы, как у обычной
+ *  строки: общая граница с первой строкой под заголовком не дублируется.
+ *  form - форма заголовка (nullptr - еще не записана)
+ */
+void PDFDocument::PlaceTableHeader(const RowLayout &layout, const std::vector<HPDF_REAL> &column_widths, HPDF_XObject &form) {
+    const HPDF_REAL table_width = HPDF_Page_GetWidth(page_) - 2 * kMargin;
+    const HPDF_REAL y_bottom_of_row = DrawTableRaw(layout, table_width, column_widths);
 
-        while (line_end != field.end()) {
-            auto next_it = line_end;
-            utf8::next(next_it, field.end());
-            std::string char_str(line_end, next_it);
+    if (!form) {
+        form = RecordTableHeader(layout, column_widths, table_width);
+    }
 
-            HPDF_REAL char_width = HPDF_Page_TextWidth(page_, char_str.c_str());
+    // форма записана относительно верхней границы строки
+    HPDF_Page_GSave(page_);
+    HPDF_Page_Concat(page_, 1, 0, 0, 1, 0, cursor_.y);
+    HPDF_Page_ExecuteXObject(page_, form);
+    HPDF_Page_GRestore(page_);
 
-            if (current_width + char_width > available_width_of_cell) {
-                break;
-            }
+    cursor_.y = y_bottom_of_row;
+}
 
-            current_width += char_width;
-            line_end = next_it;
-        }
+/*
+ *  Запись текста заголовка в форму. Координаты отсчитываются от верхней границы строки (y = 0).
+ *  Шрифт задается в самой форме: на других страницах перед ее выводом может быть выбран другой шрифт.
+ */
+HPDF_XObject PDFDocument::RecordTableHeader(const RowLayout &layout, const std::vector<HPDF_REAL> &column_widths, HPDF_REAL table_width) {
+    const HPDF_Rect bbox = {kStartPosX, -layout.height, kStartPosX + table_width, 0};
+    HPDF_XObject form = HPDF_Page_BeginFormXObject(page_, bbox);
+    if (!form) {
+        throw std::runtime_error("Error creating table header form");
+    }
 
-        if (line_start == line_end) {
-            utf8::next(line_end, field.end());
-        }
+    const HPDF_REAL row_top = cursor_.y;
+    cursor_.y = 0;
+    HPDF_Page_SetFontAndSize(page_, font_, layout.font_size);
+    AddTextToTableRow(layout, column_widths);
+    cursor_.y = row_top;
 
-        lines.emplace_back(line_start, line_end);
-        it = line_end;
+    if (HPDF_Page_EndFormXObject(page_) != HPDF_OK) {
+        throw std::runtime_error("Error creating table header form");
     }
+    return form;
+}
+
+/*
+ *  Установка шрифта таблицы: оператор Tf пишется в поток страницы только при смене размера или шрифта
+ */
+void PDFDocument::SetTableFont(HPDF_REAL font_size) {
+    if (HPDF_Page_GetCurrentFont(page_) != font_ || HPDF_Page_GetCurrentFontSize(page_) != font_size) {
+        HPDF_Page_SetFontAndSize(page_, font_, font_size);
+    }
+}
+
+void PDFTable::AddRow(const std::string_view* row_fields, size_t fields_count) {
+    if (!document_) {
+        throw std::runtime_error("Failed to add table row: table is finished");
+    }
+    document_->AddTableRow(row_fields, fields_count);
+}
+
+void PDFTable::End() {
+    if (document_) {
+        document_->EndTable();
+        document_ = nullptr;
+    }
+}
+
+/*
+ *  Рамка строки таблицы. Линии не пишутся в поток сразу, а добавляются в сетку страницы (grid_):
+ *  общие границы соседних строк не дублируются, и вся сетка выводится одним путем при смене страницы,
+ *  завершении таблицы или сохранении документа.
+ */
+HPDF_REAL PDFDocument::DrawTableRaw(const RowLayout &layout, HPDF_REAL table_width, const std::vector<HPDF_REAL> &column_widths) {
+    HPDF_REAL y_bottom_of_row = cursor_.y - layout.height;
+    grid_.AddRow(kStartPosX, kStartPosX + table_width, cursor_.y, y_bottom_of_row, column_widths);
+    return y_bottom_of_row;
+}
+
+void PDFDocument::AddTextToTableRow(const RowLayout &layout, const std::vector<HPDF_REAL> &column_widths) {
+    float x_pos_in_row = kStartPosX;
+    text_runs_.clear();
+
+    for (size_t i = 0; i < layout.cells.size(); ++i) {
+        const CellLayout &cell = layout.cells[i];
+        if (cell.lines.size() == 1) {
+            // Однострочный текст
+            AddSingleLineTextInCell(x_pos_in_row, layout.height, layout.font_size, cell.lines.front());
+        } else if (!cell.lines.empty()) {
+            // Многострочный текст
+            AddMultilineTextInCell(x_pos_in_row, layout.height, layout.font_size, cell);
+        }
+        x_pos_in_row += column_widths[i];
+    }
+
+    // весь текст строки таблицы выводится одним вызовом
+    HPDF_Page_BeginText(page_);
+    ShowTextRuns();
+    HPDF_Page_EndText(page_);
+}
+
+void PDFDocument::AddSingleLineTextInCell(HPDF_REAL x_pos_in_row, HPDF_REAL row_height, HPDF_REAL font_size, std::string_view line) {
+    HPDF_REAL text_x = x_pos_in_row + kLeftRightPadding;
+    HPDF_REAL text_y = cursor_.y - row_height / 2 - font_size / 3;
+    AddTextRun(text_x, text_y, line);
+}
+
+void PDFDocument::AddMultilineTextInCell(HPDF_REAL x_pos_in_row, HPDF_REAL row_height, HPDF_REAL font_size, const CellLayout& cell) {
+    HPDF_REAL line_height = font_size * 1.2; // Высота одной строки текста с небольшим отступом
 
     // Вычисляем стартовую позицию Y для вертикального центрирования
-    HPDF_REAL total_text_height = lines.size() * line_height;
+    HPDF_REAL total_text_height = cell.lines.size() * line_height;
     HPDF_REAL start_y = cursor_.y - (row_height - total_text_height) / 2.0 - font_size;
 
     // Проверяем, чтобы текст не выходил за нижнюю границу ячейки
@@ -432,13 +795,47 @@ void PDFDocument::AddMultilineTextInCell(HPDF_REAL x_pos_in_row, HPDF_REAL base_
 
     // Рисуем текст
     HPDF_REAL current_y = start_y;
-    for (const auto& line : lines) {
+    for (const auto& line : cell.lines) {
         HPDF_REAL text_x = x_pos_in_row + kLeftRightPadding;
-        HPDF_Page_TextOut(page_, text_x, current_y, line.c_str());
+        AddTextRun(text_x, current_y, line);
         current_y -= line_height;
     }
 }
 
+/*
+ *  Добавление строки текста в очередь вывода. Текст не копируется: строка должна оставаться
+ *  действительной до вызова ShowTextRuns.
+ */
+void PDFDocument::AddTextRun(HPDF_REAL x, HPDF_REAL y, std::string_view text) {
+    text_runs_.push_back({x, y, text.data(), static_cast<HPDF_UINT>(text.size())});
+}
+
+/*
+ *  Вывод накопленных строк (внутри BeginText/EndText).
+ *  Каждая строка выводится так же, как HPDF_Page_TextOut, но состояние страницы проверяется один раз
+ *  на весь набор, а строкам не нужна завершающая '\0'.
+ */
+void PDFDocument::ShowTextRuns() {
+    if (text_runs_.empty()) return;
+
+    const HPDF_STATUS status = HPDF_Page_ShowTextRuns(page_, text_runs_.data(), static_cast<HPDF_UINT>(text_runs_.size()));
+    text_runs_.clear();
+    if (status != HPDF_OK) {
+        throw std::runtime_error("Error writing text to page");
+    }
+}
+
+void PDFDocument::AddTextRuns(const TextRun* runs, size_t count) {
+    text_runs_.clear();
+    for (size_t i = 0; i < count; ++i) {
+        AddTextRun(runs[i].x, runs[i].y, runs[i].text);
+    }
+
+    HPDF_Page_BeginText(page_);
+    ShowTextRuns();
+    HPDF_Page_EndText(page_);
+}
+
 /*void PDFDocument::AddMultilineTextInCell(HPDF_REAL x_pos_in_row, HPDF_REAL base_column_width, HPDF_REAL font_size, const std::string& field) const {
     HPDF_REAL available_width_of_cell = base_column_width - 2 * kLeftRightPadding;
     // Начинаем с начала строки
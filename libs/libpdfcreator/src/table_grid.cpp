@@ -0,0 +1,71 @@
+#include "pdfcreator/table_grid.h"
+
+void TableGrid::AddRow(HPDF_REAL left, HPDF_REAL right, HPDF_REAL top, HPDF_REAL bottom,
+                       const std::vector<HPDF_REAL>& column_widths) {
+    // продолжение блока: верхняя граница строки уже нарисована как нижняя граница предыдущей,
+    // вертикальные линии блока удлиняются
+    if (ContinuesLastBlock(left, right, top, column_widths)) {
+        blocks_.back().bottom = bottom;
+        horizontal_.push_back({bottom, left, right});
+        return;
+    }
+
+    // новый блок; верхняя граница пропускается, если совпадает с последней нарисованной
+    if (horizontal_.empty() || horizontal_.back().y != top ||
+        horizontal_.back().left != left || horizontal_.back().right != right) {
+        horizontal_.push_back({top, left, right});
+    }
+    horizontal_.push_back({bottom, left, right});
+
+    blocks_.push_back({xs_.size(), column_widths.size() + 1, top, bottom});
+    // координаты накапливаются так же, как при рисовании строки, чтобы сравнение в ContinuesLastBlock было точным
+    HPDF_REAL x = left;
+    for (size_t i = 0; i <= column_widths.size(); ++i) {
+        xs_.push_back(x);
+        if (i < column_widths.size()) x += column_widths[i];
+    }
+}
+
+bool TableGrid::ContinuesLastBlock(HPDF_REAL left, HPDF_REAL right, HPDF_REAL top,
+                                   const std::vector<HPDF_REAL>& column_widths) const {
+    if (blocks_.empty()) return false;
+
+    const Block& block = blocks_.back();
+    const HorizontalLine& last_line = horizontal_.back();
+    if (block.bottom != top || last_line.left != left || last_line.right != right ||
+        block.x_count != column_widths.size() + 1) {
+        return false;
+    }
+
+    HPDF_REAL x = left;
+    for (size_t i = 0; i < block.x_count; ++i) {
+        if (xs_[block.first_x + i] != x) return false;
+        if (i < column_widths.size()) x += column_widths[i];
+    }
+    return true;
+}
+
+void TableGrid::Flush(HPDF_Page page, HPDF_REAL line_width) {
+    if (Empty()) return;
+
+    HPDF_Page_SetLineWidth(page, line_width);
+    for (const HorizontalLine& line : horizontal_) {
+        HPDF_Page_MoveTo(page, line.left, line.y);
+        HPDF_Page_LineTo(page, line.right, line.y);
+    }
+    for (const Block& block : blocks_) {
+        for (size_t i = block.first_x; i < block.first_x + block.x_count; ++i) {
+            HPDF_Page_MoveTo(page, xs_[i], block.top);
+            HPDF_Page_LineTo(page, xs_[i], block.bottom);
+        }
+    }
+    HPDF_Page_Stroke(page);
+
+    Clear();
+}
+
+void TableGrid::Clear() {
+    horizontal_.clear();
+    xs_.clear();
+    blocks_.clear();
+}